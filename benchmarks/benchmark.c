@@ -21,7 +21,628 @@
 
 #include "benchmark.h"
 
+static long const BenchmarkOperationsCount = 1000000;
+
+// ------------------------------------------------------------- Reporting ------
+
+static int BenchmarkCompareSamples(void const* sample1, void const* sample2) {
+    uint64_t const value1 = *(uint64_t const*)sample1;
+    uint64_t const value2 = *(uint64_t const*)sample2;
+    return (value1 > value2) - (value1 < value2);
+}
+
+// Prints the total time and the p50/p99/max latency of the `samples`, which
+// are per-operation durations in nanoseconds, and sorts them in the process.
+static void BenchmarkReport(char const* name, uint64_t* samples, long count) {
+    uint64_t total = 0;
+    for (long i = 0; i < count; i += 1) total += samples[i];
+
+    qsort(samples, count, sizeof(uint64_t), BenchmarkCompareSamples);
+
+    uint64_t const p50 = samples[count / 2];
+    uint64_t const p99 = samples[count * 99 / 100];
+    uint64_t const max = samples[count - 1];
+
+    printf("%-32s %8.2f ms total, p50 %6llu ns, p99 %6llu ns, max %9llu ns\n", name, total / 1e6, (unsigned long long)p50, (unsigned long long)p99, (unsigned long long)max);
+}
+
+// ------------------------------------------------------------ Benchmarks ------
+
+static void BenchmarkDictionarySetTo(uint64_t* samples) {
+    MLVariable dictionary = MLDictionaryMake(0, MLMore);
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        MLVariable key = MLNumberMake(i);
+
+        uint64_t const start = BenchmarkNow();
+        MLSend(dictionary, "set*to*", key, key);
+        samples[i] = BenchmarkNow() - start;
+
+        MLSend(key, "release");
+    }
+
+    MLSend(dictionary, "release");
+    BenchmarkReport("Dictionary set*to*", samples, BenchmarkOperationsCount);
+}
+
+static void BenchmarkStringIntern(uint64_t* samples) {
+    MLVariable* strings = calloc(BenchmarkOperationsCount, sizeof(MLVariable));
+    char characters[32];
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        int const length = snprintf(characters, sizeof(characters), "key-%ld", i);
+
+        uint64_t const start = BenchmarkNow();
+        strings[i] = MLStringMake(length, characters);
+        samples[i] = BenchmarkNow() - start;
+    }
+
+    BenchmarkReport("String intern", samples, BenchmarkOperationsCount);
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        MLSend(strings[i], "release");
+        samples[i] = BenchmarkNow() - start;
+    }
+
+    BenchmarkReport("String release (un-intern)", samples, BenchmarkOperationsCount);
+    free(strings);
+}
+
+// Splices short pieces into a string that grows to several megabytes.
+static void BenchmarkStringSplice(uint64_t* samples) {
+    long const operationsCount = BenchmarkOperationsCount / 4;
+    MLVariable string = MLSend(MLString, "create", MLString("mutable"), MLYes);
+    MLVariable piece = MLStringMake(16, "0123456789abcdef");
+    unsigned seed = 42;
+
+    for (long i = 0; i < operationsCount; i += 1) {
+        seed = seed * 1103515245 + 12345;
+        MLVariable index = MLNumberMake(i == 0 ? 0 : (seed >> 8) % (i * 16));
+
+        uint64_t const start = BenchmarkNow();
+        MLSend(string, "replace-at*count*with*", index, MLNumber(0), piece);
+        samples[i] = BenchmarkNow() - start;
+
+        MLSend(index, "release");
+    }
+
+    MLSend(piece, "release");
+    BenchmarkReport("String replace-at*count*with*", samples, operationsCount);
+}
+
+// Appends a 100k-object array to an empty array, then inserts it again at the front.
+static void BenchmarkArrayReplace(uint64_t* samples) {
+    long const operationsCount = 50;
+    long const objectsCount = 100000;
+    MLVariable objects = MLArray(MLMore);
+
+    for (long i = 0; i < objectsCount; i += 1) {
+        MLVariable number = MLNumberMake(i);
+        MLSend(objects, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(number));
+        MLSend(number, "release");
+    }
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        MLVariable array = MLArray(MLMore);
+        uint64_t const start = BenchmarkNow();
+        MLSend(array, "replace-at*count*with*", MLNumber(0), MLNumber(0), objects);
+        MLSend(array, "replace-at*count*with*", MLNumber(0), MLNumber(0), objects);
+        samples[i] = BenchmarkNow() - start;
+    }
+
+    BenchmarkReport("Array replace-at*count*with* (2 x 100k objects)", samples, operationsCount);
+}
+
+// Looks up 10k dictionary entries keyed by immutable pairs of numbers.
+static void BenchmarkCompositeKeys(uint64_t* samples) {
+    long const operationsCount = 50;
+    long const keysCount = 10000;
+    MLVariable dictionary = MLDictionary(MLMore);
+    MLVariable keys = MLArray(MLMore);
+
+    for (long i = 0; i < keysCount; i += 1) MLCollect {
+        MLVariable key = MLArray(MLNumber(i), MLNumber(i * 7));
+        MLSend(dictionary, "set*to*", key, MLNumber(i));
+        MLSend(keys, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(key));
+    }
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLForEach(key, keys) MLSend(dictionary, "get*", key);
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Dictionary get* with array keys (10k)", samples, operationsCount);
+}
+
+// Pops the front of a 100k queue and pushes the object back at the end.
+static void BenchmarkArrayQueue(uint64_t* samples) {
+    long const operationsCount = 100000;
+    long const objectsCount = 100000;
+    MLVariable queue = MLArray(MLMore);
+    MLVariable empty = MLArray();
+
+    for (long i = 0; i < objectsCount; i += 1) MLCollect {
+        MLSend(queue, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(i)));
+    }
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLVariable first = MLSend(queue, "at*", MLNumber(0));
+        MLVariable pushed = MLArray(first);
+        MLSend(queue, "replace-at*count*with*", MLNumber(0), MLNumber(1), empty);
+        MLSend(queue, "replace-at*count*with*", MLNumber(objectsCount - 1), MLNumber(0), pushed);
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Array queue pop and push (100k objects)", samples, operationsCount);
+}
+
+// Copies a 100k mutable array, then changes one object of the copy.
+static void BenchmarkArrayCopy(uint64_t* samples) {
+    long const operationsCount = 50;
+    long const objectsCount = 100000;
+    MLVariable objects = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(objectsCount));
+
+    for (long i = 0; i < objectsCount; i += 1) MLCollect {
+        MLSend(objects, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(i)));
+    }
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLSend(MLSend(objects, "copy"), "release");
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Array copy (100k objects)", samples, operationsCount);
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        MLVariable copy = MLSend(MLSend(objects, "copy", MLString("mutable"), MLYes), "collect");
+        uint64_t const start = BenchmarkNow();
+        MLSend(copy, "replace-at*count*with*", MLNumber(0), MLNumber(1), MLArray(MLNumber(-1)));
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Array first write after copy (100k objects)", samples, operationsCount);
+}
+
+// Sums a column of 1M numbers, packed and as an array of boxed numbers.
+static void BenchmarkNumberArraySum(uint64_t* samples) {
+    long const operationsCount = 50;
+    long const numbersCount = 1 << 20;
+    MLVariable numbers = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(numbersCount));
+    MLVariable column = MLSend(MLNumberArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(numbersCount));
+
+    for (long i = 0; i < numbersCount; i += 1) MLCollect {
+        MLSend(numbers, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(i * 0.5)));
+    }
+    MLSend(column, "replace-at*count*with*", MLNumber(0), MLNumber(0), numbers);
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLDecimal sum = 0;
+        for (long j = 0; j < numbersCount; j += 1) sum += MLDecimalFrom(MLSend(numbers, "at*", MLNumber(j)));
+        samples[i] = BenchmarkNow() - start;
+        if (sum < 0) printf("%f\n", sum);
+    }
+    BenchmarkReport("Array of numbers summed (1M)", samples, operationsCount);
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLSend(column, "sum");
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("NumberArray sum (1M)", samples, operationsCount);
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLSend(column, "dot*", column);
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("NumberArray dot* (1M)", samples, operationsCount);
+}
+
+// Visits 100k objects of an array with at* and with MLForEach, and the keys
+// of a dictionary with MLForEach.
+static void BenchmarkEnumerate(uint64_t* samples) {
+    long const operationsCount = 50;
+    long const objectsCount = 100000;
+    MLVariable array = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(objectsCount));
+    MLVariable dictionary = MLSend(MLDictionary, "create", MLString("mutable"), MLYes);
+
+    for (long i = 0; i < objectsCount; i += 1) MLCollect {
+        MLSend(array, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(i)));
+        MLSend(dictionary, "set*to*", MLNumber(i), MLYes);
+    }
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        long const count = MLIntegerFrom(MLSend(array, "count"));
+        for (long j = 0; j < count; j += 1) MLSend(array, "at*", MLNumber(j));
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Array at* loop (100k)", samples, operationsCount);
+
+    for (long i = 0; i < operationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        long visited = 0;
+        MLForEach(object, array) visited += 1;
+        samples[i] = BenchmarkNow() - start;
+        if (visited != objectsCount) printf("Visited %ld objects\n", visited);
+    }
+    BenchmarkReport("Array MLForEach (100k)", samples, operationsCount);
+
+    for (long i = 0; i < operationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        long visited = 0;
+        MLForEach(key, dictionary) visited += 1;
+        samples[i] = BenchmarkNow() - start;
+        if (visited != objectsCount) printf("Visited %ld keys\n", visited);
+    }
+    BenchmarkReport("Dictionary MLForEach (100k)", samples, operationsCount);
+}
+
+static MLVariable BenchmarkSquare(MLVariable block, MLVariable super, MLVariable command, MLVariable object, ...) {
+    MLDecimal const value = MLDecimalFrom(object);
+    return MLNumber(value * value);
+}
+
+static void BenchmarkArrayMap(uint64_t* samples) {
+    long const operationsCount = 50;
+    long const objectsCount = 100000;
+    MLVariable array = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(objectsCount));
+    MLVariable square = MLBlock(BenchmarkSquare);
+
+    for (long i = 0; i < objectsCount; i += 1) MLCollect {
+        MLSend(array, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(i + 0.5)));
+    }
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLSend(array, "map*", square);
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Array map* (100k)", samples, operationsCount);
+}
+
+static MLVariable BenchmarkCompare(MLVariable block, MLVariable super, MLVariable command, MLVariable object1, MLVariable object2, ...) {
+    return MLSend(object1, "compare*", object2);
+}
+
+static void BenchmarkArraySort(uint64_t* samples) {
+    long const operationsCount = 20;
+    long const objectsCount = 100000;
+    MLVariable array = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(objectsCount));
+    MLVariable compare = MLBlock(BenchmarkCompare);
+    unsigned long seed = 1;
+
+    for (long i = 0; i < objectsCount; i += 1) MLCollect {
+        seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+        MLSend(array, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(seed >> 11)));
+    }
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLSend(array, "sort");
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Array sort (100k numbers)", samples, operationsCount);
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        MLSend(array, "sort-by*", compare);
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Array sort-by* compare* (100k)", samples, operationsCount);
+}
+
+static void BenchmarkStringBuilderAppend(uint64_t* samples) {
+    MLVariable builder = MLSend(MLStringBuilder, "create");
+    MLVariable piece = MLStringMake(16, "0123456789abcdef");
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        MLSend(builder, "append*", piece);
+        samples[i] = BenchmarkNow() - start;
+    }
+
+    uint64_t const start = BenchmarkNow();
+    MLVariable string = MLSend(builder, "freeze");
+    uint64_t const end = BenchmarkNow();
+
+    printf("%-32s %8.2f ms total for %ld MB\n", "StringBuilder freeze", (end - start) / 1e6, MLIntegerFrom(MLSend(string, "length")) >> 20);
+    MLSend(piece, "release");
+    BenchmarkReport("StringBuilder append*", samples, BenchmarkOperationsCount);
+}
+
+static void BenchmarkNumberAsString(uint64_t* samples) {
+    MLVariable numbers[1024];
+    for (long i = 0; i < 1024; i += 1) numbers[i] = MLNumberMake(i % 2 == 0 ? i * 1.1 / 7 : i * 31);
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        MLCollect {
+            uint64_t const start = BenchmarkNow();
+            MLSend(numbers[i % 1024], "as-string");
+            samples[i] = BenchmarkNow() - start;
+        }
+    }
+
+    for (long i = 0; i < 1024; i += 1) MLSend(numbers[i], "release");
+    BenchmarkReport("Number as-string", samples, BenchmarkOperationsCount);
+}
+
+static void BenchmarkStringAsNumber(uint64_t* samples) {
+    MLVariable strings[1024];
+    for (long i = 0; i < 1024; i += 1) {
+        char buffer[32];
+        int const length = snprintf(buffer, sizeof(buffer), "%.6g", i * 1.1 / 7);
+        strings[i] = MLStringMake(length, buffer);
+    }
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        MLCollect {
+            uint64_t const start = BenchmarkNow();
+            MLSend(strings[i % 1024], "as-number");
+            samples[i] = BenchmarkNow() - start;
+        }
+    }
+
+    for (long i = 0; i < 1024; i += 1) MLSend(strings[i], "release");
+    BenchmarkReport("String as-number", samples, BenchmarkOperationsCount);
+}
+
+// Encodes 4 MB with the given command (base64, hex), then decodes it again.
+static void BenchmarkCodec(uint64_t* samples, char const* encodeName, char const* decodeName, MLVariable encode, MLVariable decode) {
+    long const size = 4 << 20;
+    long const operationsCount = 100;
+    char* bytes = malloc(size);
+
+    for (long i = 0; i < size; i += 1) bytes[i] = (char)(i * 31 + 7);
+    MLVariable data = MLDataMake(size, bytes);
+    MLVariable string = MLZero;
+
+    for (long i = 0; i < operationsCount; i += 1) {
+        MLCollect {
+            uint64_t const start = BenchmarkNow();
+            MLSend(data, encode);
+            samples[i] = BenchmarkNow() - start;
+        }
+    }
+
+    BenchmarkReport(encodeName, samples, operationsCount);
+    printf("%-32s %8.2f GB/s\n", encodeName, size / (double)samples[operationsCount / 2]);
+
+    MLCollect { string = MLSend(MLSend(data, encode), "retain"); }
+
+    for (long i = 0; i < operationsCount; i += 1) {
+        MLCollect {
+            uint64_t const start = BenchmarkNow();
+            MLSend(MLData, decode, string);
+            samples[i] = BenchmarkNow() - start;
+        }
+    }
+
+    BenchmarkReport(decodeName, samples, operationsCount);
+    printf("%-32s %8.2f GB/s\n", decodeName, size / (double)samples[operationsCount / 2]);
+
+    MLSend(string, "release");
+    MLSend(data, "release");
+    free(bytes);
+}
+
+// Hashes a mutable data object of the given size over and over, appending
+// nothing in between to invalidate its cached hash.
+static void BenchmarkDigest(uint64_t* samples, char const* name, long size, long operationsCount) {
+    MLVariable data = MLSend(MLData, "create", MLString("mutable"), MLYes);
+    MLVariable empty = MLDataMake(0, "");
+    MLVariable end = MLNumberMake(size);
+    char* bytes = malloc(size);
+
+    for (long i = 0; i < size; i += 1) bytes[i] = (char)(i * 31 + 7);
+    MLVariable contents = MLDataMake(size, bytes);
+    MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(0), contents);
+
+    for (long i = 0; i < operationsCount; i += 1) {
+        MLSend(data, "replace-at*count*with*", end, MLNumber(0), empty);
+
+        uint64_t const start = BenchmarkNow();
+        MLSend(data, "hash");
+        samples[i] = BenchmarkNow() - start;
+    }
+
+    BenchmarkReport(name, samples, operationsCount);
+
+    uint64_t const median = samples[operationsCount / 2];
+    printf("%-32s %8.2f GB/s\n", name, size / (double)median);
+
+    MLSend(contents, "release");
+    MLSend(end, "release");
+    MLSend(empty, "release");
+    free(bytes);
+}
+
+// Slices a payload into fields, the way a parser would.
+static void BenchmarkDataSlice(uint64_t* samples, char const* name, long fieldCount) {
+    long const payloadCount = 512 * 1024;
+    char* bytes = calloc(payloadCount, 1);
+    MLVariable payload = MLDataMake(payloadCount, bytes);
+    long const fieldsCount = payloadCount / fieldCount;
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        MLVariable index = MLNumberMake((i % fieldsCount) * fieldCount);
+        MLVariable count = MLNumberMake(fieldCount);
+
+        MLCollect {
+            uint64_t const start = BenchmarkNow();
+            MLSend(payload, "at*count*", index, count);
+            samples[i] = BenchmarkNow() - start;
+        }
+
+        MLSend(count, "release");
+        MLSend(index, "release");
+    }
+
+    BenchmarkReport(name, samples, BenchmarkOperationsCount);
+    MLSend(payload, "release");
+    free(bytes);
+}
+
+static void* BenchmarkStringInternThread(void* argument) {
+    long const operationsCount = *(long*)argument;
+    char characters[32];
+
+    for (long i = 0; i < operationsCount; i += 1) {
+        int const length = snprintf(characters, sizeof(characters), "key-%ld", i % 4096);
+        MLSend(MLStringMake(length, characters), "release");
+    }
+
+    return MLZero;
+}
+
+// Reports interning throughput for an increasing number of threads making
+// and releasing strings drawn from a shared set of keys.
+static void BenchmarkStringInternScaling() {
+    for (long threadsCount = 1; threadsCount <= 8; threadsCount *= 2) {
+        pthread_t threads[8];
+        long operationsCount = BenchmarkOperationsCount / threadsCount;
+
+        uint64_t const start = BenchmarkNow();
+        for (long i = 0; i < threadsCount; i += 1) pthread_create(&threads[i], NULL, BenchmarkStringInternThread, &operationsCount);
+        for (long i = 0; i < threadsCount; i += 1) pthread_join(threads[i], NULL);
+        uint64_t const duration = BenchmarkNow() - start;
+
+        char name[32];
+        snprintf(name, sizeof(name), "String intern, %ld thread(s)", threadsCount);
+        printf("%-32s %8.2f Mops/s\n", name, BenchmarkOperationsCount / (duration / 1e3));
+    }
+}
+
+// Lookups take only a few nanoseconds, so each sample times a batch of them
+// and records the average.
+static void BenchmarkLookup(uint64_t* samples, char const* name, MLVariable object, MLVariable command) {
+    long const batchCount = 64;
+    MLVariable super = MLZero;
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        for (long j = 0; j < batchCount; j += 1) MLLookup(object, command, &super);
+        samples[i] = (BenchmarkNow() - start) / batchCount;
+    }
+
+    BenchmarkReport(name, samples, BenchmarkOperationsCount);
+}
+
+static void BenchmarkSendLiteral(uint64_t* samples) {
+    long const batchCount = 64;
+    MLVariable dictionary = MLDictionaryMake(0, MLMore);
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        for (long j = 0; j < batchCount; j += 1) MLSend(dictionary, "count");
+        samples[i] = (BenchmarkNow() - start) / batchCount;
+    }
+
+    BenchmarkReport("Send with literal command", samples, BenchmarkOperationsCount);
+    MLSend(dictionary, "release");
+}
+
+static MLVariable BenchmarkBlockWork(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    uint64_t hash = MLIntegerFrom(number);
+    for (long i = 0; i < 100000; i += 1) hash = hash * 6364136223846793005ull + 1442695040888963407ull;
+    return MLNumber(hash >> 12);
+}
+
+// Runs batches of 64 CPU-bound blocks, one after another, then spawned on the
+// pool and joined, and reports the time per batch.
+static void BenchmarkBlockSpawn(uint64_t* samples) {
+    long const operationsCount = 50;
+    long const batchCount = 64;
+    MLVariable block = MLBlock(BenchmarkBlockWork);
+    MLVariable futures[64];
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        for (long j = 0; j < batchCount; j += 1) BenchmarkBlockWork(block, MLZero, MLZero, MLNumber(j), MLZero);
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Block call (64 blocks)", samples, operationsCount);
+
+    for (long i = 0; i < operationsCount; i += 1) MLCollect {
+        uint64_t const start = BenchmarkNow();
+        for (long j = 0; j < batchCount; j += 1) futures[j] = MLSend(block, "spawn*", MLNumber(j));
+        for (long j = 0; j < batchCount; j += 1) MLSend(futures[j], "join");
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Block spawn* and join (64 blocks)", samples, operationsCount);
+}
+
+// Enters one perform block, raising `exception` in it unless it's zero. Kept
+// out of line so the loops timing it don't live across the sigsetjmp.
+__attribute__((noinline)) static void BenchmarkPerform(MLVariable exception, long volatile* handledCount) {
+    MLPerform { if (exception != MLZero) MLRaise(exception); } MLHandle { *handledCount += 1; }
+}
+
+// Enters perform blocks that complete normally, which is the common case, then
+// ones that raise and handle an exception.
+static void BenchmarkPerformHandle(uint64_t* samples) {
+    long const batchCount = 64;
+    MLVariable exception = MLStringMake(sizeof("Exception"), "Exception");
+    long volatile handledCount = 0;
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        for (long j = 0; j < batchCount; j += 1) BenchmarkPerform(MLZero, &handledCount);
+        samples[i] = (BenchmarkNow() - start) / batchCount;
+    }
+    BenchmarkReport("Perform without raise", samples, BenchmarkOperationsCount);
+
+    for (long i = 0; i < BenchmarkOperationsCount; i += 1) {
+        uint64_t const start = BenchmarkNow();
+        BenchmarkPerform(exception, &handledCount);
+        samples[i] = BenchmarkNow() - start;
+    }
+    BenchmarkReport("Perform with raise and handle", samples, BenchmarkOperationsCount);
+
+    MLSend(exception, "release");
+}
+
+// ------------------------------------------------------------------ Main ------
+
 int main(int argumentsCount, char const* arguments[]) {
-    // TODO: add benchmarks.
+    uint64_t* samples = calloc(BenchmarkOperationsCount, sizeof(uint64_t));
+
+    BenchmarkDictionarySetTo(samples);
+    BenchmarkStringIntern(samples);
+    BenchmarkStringInternScaling();
+    MLCollect { BenchmarkStringSplice(samples); }
+    MLCollect { BenchmarkStringBuilderAppend(samples); }
+    MLCollect { BenchmarkArrayReplace(samples); }
+    MLCollect { BenchmarkArrayCopy(samples); }
+    MLCollect { BenchmarkArrayQueue(samples); }
+    MLCollect { BenchmarkCompositeKeys(samples); }
+    MLCollect { BenchmarkNumberArraySum(samples); }
+    MLCollect { BenchmarkEnumerate(samples); }
+    MLCollect { BenchmarkArrayMap(samples); }
+    MLCollect { BenchmarkArraySort(samples); }
+    MLCollect { BenchmarkBlockSpawn(samples); }
+    BenchmarkNumberAsString(samples);
+    BenchmarkStringAsNumber(samples);
+    BenchmarkDataSlice(samples, "Data at*count* (128 bytes)", 128);
+    BenchmarkDataSlice(samples, "Data at*count* (4 KB)", 4096);
+    MLCollect { BenchmarkDigest(samples, "Digest 8 bytes", 8, 100000); }
+    MLCollect { BenchmarkDigest(samples, "Digest 32 bytes", 32, 100000); }
+    MLCollect { BenchmarkDigest(samples, "Digest 4 MB", 4 << 20, 200); }
+    MLCollect { BenchmarkCodec(samples, "Data base64 (4 MB)", "Data decode-base64* (4 MB)", MLString("base64"), MLString("decode-base64*")); }
+    MLCollect { BenchmarkCodec(samples, "Data hex (4 MB)", "Data decode-hex* (4 MB)", MLString("hex"), MLString("decode-hex*")); }
+
+    MLVariable dictionary = MLDictionaryMake(0, MLMore);
+    MLVariable count = MLStringMake(sizeof("count"), "count");
+    MLVariable isKindOf = MLStringMake(sizeof("is-kind-of*"), "is-kind-of*");
+    BenchmarkLookup(samples, "Lookup own method", dictionary, count);
+    BenchmarkLookup(samples, "Lookup inherited method", dictionary, isKindOf);
+    MLSend(isKindOf, "release");
+    MLSend(count, "release");
+    MLSend(dictionary, "release");
+    MLCollect { BenchmarkSendLiteral(samples); }
+    BenchmarkPerformHandle(samples);
+
+    free(samples);
     return 0;
 }
@@ -23,7 +23,17 @@
 #define BENCHMARK_H
 
 #include <metal/metal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
 
-// TODO: add benchmarks.
+// Returns a monotonic timestamp in nanoseconds.
+static inline uint64_t BenchmarkNow() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+}
 
 #endif
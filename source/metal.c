@@ -27,6 +27,17 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 // --------------------------------------------------------------- Macros ------
 
@@ -43,6 +54,7 @@
 #define array(pointer) (*((struct MLArray*)pointer))
 #define string(pointer) (*((struct MLString*)pointer))
 #define dictionary(pointer) (*((struct MLDictionary*)pointer))
+#define persistentDictionary(pointer) (*((struct MLPersistentDictionary*)pointer))
 #define exception(pointer) (*((struct MLException*)pointer))
 
 #define MLBootstrap __attribute__((constructor(128)))
@@ -52,7 +64,9 @@
 
 static MLInteger const MLDataDefaultCapacity = 16;
 static MLInteger const MLArrayDefaultCapacity = 16;
+static MLInteger const MLNumberArrayDefaultCapacity = 16;
 static MLInteger const MLStringDefaultCapacity = 15; // +1 for '\0'
+static MLInteger const MLStringBuilderDefaultCapacity = 63; // +1 for '\0'
 static MLInteger const MLDictionaryDefaultCapacity = 8;
 static MLInteger const MLCacheDefaultCapacity = 32;
 static MLInteger const MLChildrenDefaultCapacity = 8;
@@ -61,11 +75,84 @@ static MLInteger const MLCollectBlockDefaultCapacity = 2048;
 static MLInteger const MLSymbolTableBlockDefaultCapacity = 2048;
 static MLInteger const MLStringTableBlockDefaultCapacity = 2048;
 static MLInteger const MLMaxKeyAndCommandLength = 2048;
+static MLNatural const MLTableMinimumCapacity = 8;
+static MLNatural const MLTableMigrationSteps = 8;
+static MLNatural const MLTableProbeSaturated = UINT8_MAX;
+static MLNatural const MLInternShardBits = 6;
+static MLNatural const MLInternShardsCount = 1 << 6;
+static MLNatural const MLEpochReclaimInterval = 64;
+static MLNatural const MLDictionaryMigrationSteps = 8;
+
+static uint64_t const MLDigestSecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+static MLInteger const MLSliceMinimumCount = 32;
+static MLInteger const MLSlicePinCount = 1 << 20;
+static MLInteger const MLSlicePinRatio = 64;
+
+static MLInteger const MLStringRopeThreshold = 4096;
+static MLInteger const MLRopeChunkCapacity = 1024;
+
+static MLInteger const MLNumberFormatMaximumLength = 32;
+static MLInteger const MLNumberExactDigitsCount = 19;
+static uint64_t const MLNumberExactMantissaMax = 1ull << 53;
+
+// Normalized powers of ten 10^k = f * 2^e for k = -348, -340, ..., 340:
+static uint64_t const MLNumberCachedPowersF[87] = {
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull, 0xcf42894a5dce35eaull,
+    0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull, 0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full,
+    0xbe5691ef416bd60cull, 0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull, 0xc21094364dfb5637ull,
+    0x9096ea6f3848984full, 0xd77485cb25823ac7ull, 0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull,
+    0xb23867fb2a35b28eull, 0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull, 0xb5b5ada8aaff80b8ull,
+    0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull, 0x964e858c91ba2655ull, 0xdff9772470297ebdull,
+    0xa6dfbd9fb8e5b88full, 0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull, 0xaa242499697392d3ull,
+    0xfd87b5f28300ca0eull, 0xbce5086492111aebull, 0x8cbccc096f5088ccull, 0xd1b71758e219652cull,
+    0x9c40000000000000ull, 0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull, 0x9f4f2726179a2245ull,
+    0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull, 0x83c7088e1aab65dbull, 0xc45d1df942711d9aull,
+    0x924d692ca61be758ull, 0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull, 0x952ab45cfa97a0b3ull,
+    0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull, 0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull,
+    0x88fcf317f22241e2ull, 0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull, 0x8bab8eefb6409c1aull,
+    0xd01fef10a657842cull, 0x9b10a4e5e9913129ull, 0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull,
+    0x80444b5e7aa7cf85ull, 0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull
+};
+
+static int16_t const MLNumberCachedPowersE[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+static MLInteger const MLCodecSlack = 32;
+static MLInteger const MLVectorLanesCount = 4;
+static MLInteger const MLPoolDequeCapacity = 256; // power of two
+static MLInteger const MLPoolChunkMinimumCount = 1024;
+static MLInteger const MLPoolChunksPerWorker = 8;
 
-static MLNatural const MLFlagBits = 0x3;
-static MLNatural const MLFlagBitsCount = 2;
+static MLInteger const MLSortMinimumRunCount = 64;
+static MLInteger const MLSortRunsCapacity = 128;
+static MLInteger const MLEnumerationBufferCount = sizeof(((struct MLEnumeration*)0)->buffer) / sizeof(MLVariable);
+static char const MLBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static MLNatural const MLTrieBitsPerLevel = 5;
+static MLNatural const MLTrieLevelMask = (1 << 5) - 1;
+static MLNatural const MLTrieHashBits = sizeof(MLNatural) * CHAR_BIT;
+
+static MLNatural const MLFlagBits = 0x7;
+static MLNatural const MLFlagBitsCount = 3;
 static MLNatural const MLMutableFlag = 1 << 0;
 static MLNatural const MLInlineFlag = 1 << 1;
+static MLNatural const MLMappedFlag = 1 << 2;
 
 static MLNatural const MLRetainCountOne = MLFlagBits + 1;
 static MLNatural const MLRetainCountMax = MLNaturalMax & ~MLFlagBits;
@@ -73,17 +160,23 @@ static MLNatural const MLRetainCountMax = MLNaturalMax & ~MLFlagBits;
 // ----------------------------------------------------------- Structures ------
 
 struct MLEntry {
-    MLNatural probe;
     MLNatural key;
     MLNatural value;
-    MLNatural extra;
 };
 
+// Entries and their probe distances live in one allocation: `capacity`
+// entries followed by `capacity` probe bytes, where 0 marks an empty slot.
 struct MLTable {
     MLNatural mask;
     MLNatural count;
     MLNatural probeMax;
     struct MLEntry* entries;
+    uint8_t* probes;
+    MLNatural maskOld;
+    MLNatural probeMaxOld;
+    MLNatural migrated;
+    struct MLEntry* entriesOld;
+    uint8_t* probesOld;
 };
 
 struct MLMeta {
@@ -123,9 +216,16 @@ struct MLData {
     MLInteger capacity;
     MLInteger count;
     MLNatural hash;
+    struct MLBuffer* parent;
+    struct MLViews* views;
+    MLInteger viewIndex;
     void* bytes;
+    MLNatural mutations;
 };
 
+// Mutable arrays also keep free slots before `objects`, `head` of them, to
+// grow and shrink at the front without moving everything. `capacity` counts
+// the slots from `objects` on.
 struct MLArray {
     struct MLMeta* meta;
     MLNatural retainCountAndFlags;
@@ -133,14 +233,93 @@ struct MLArray {
     MLInteger count;
     MLNatural hash;
     MLVariable* objects;
+    MLNatural mutations;
+    MLInteger* shares;
+    MLInteger head;
+};
+
+// Numbers packed contiguously as raw decimals (double) or integers (int64),
+// they're only boxed when a single element is accessed.
+struct MLNumberArray {
+    struct MLMeta* meta;
+    MLNatural retainCountAndFlags;
+    MLInteger capacity;
+    MLInteger count;
+    bool isInteger;
+    union {
+        double* decimals;
+        int64_t* integers;
+        void* values;
+    };
 };
 
+// Large mutable strings keep their characters in a `rope` instead, and are
+// flattened back into `characters` when those are needed.
 struct MLString {
     struct MLMeta* meta;
     MLNatural retainCountAndFlags;
     MLInteger capacity;
     MLInteger length;
     MLNatural hash;
+    struct MLBuffer* parent;
+    struct MLViews* views;
+    MLInteger viewIndex;
+    char* characters;
+    struct MLRope* rope;
+};
+
+// The layout Data and String share, which lets slicing treat them alike. A
+// slice (view) retains its `parent` and points into the parent's bytes,
+// mutable parents keep track of their `views` to materialize them before
+// they change.
+struct MLBuffer {
+    struct MLMeta* meta;
+    MLNatural retainCountAndFlags;
+    MLInteger capacity;
+    MLInteger count;
+    MLNatural hash;
+    struct MLBuffer* parent;
+    struct MLViews* views;
+    MLInteger viewIndex;
+    char* bytes;
+};
+
+struct MLViews {
+    MLInteger count;
+    MLInteger capacity;
+    struct MLBuffer* objects[];
+};
+
+_Static_assert(offsetof(struct MLData, bytes) == offsetof(struct MLBuffer, bytes), "Data must share the layout of MLBuffer");
+_Static_assert(offsetof(struct MLString, characters) == offsetof(struct MLBuffer, bytes), "String must share the layout of MLBuffer");
+_Static_assert(offsetof(struct MLString, characters) == offsetof(struct MLStringConstant, characters), "String constants must share the layout of String");
+_Static_assert(offsetof(struct MLString, hash) == offsetof(struct MLStringConstant, hash), "String constants must share the layout of String");
+_Static_assert(sizeof(struct MLString) == offsetof(struct MLStringConstant, resolved), "String constants must share the layout of String");
+
+// A treap of character chunks ordered by position, `length` is the length of
+// the whole subtree and `count` that of the node's own chunk.
+struct MLRope {
+    struct MLRope* left;
+    struct MLRope* right;
+    MLNatural priority;
+    MLInteger length;
+    MLInteger count;
+    char characters[];
+};
+
+// A floating point number f * 2^e with a 64-bit significand.
+struct MLDiyFp {
+    uint64_t f;
+    int e;
+};
+
+// Grows geometrically while appending, `freeze` hands `characters` over to an
+// immutable string.
+struct MLStringBuilder {
+    struct MLMeta* meta;
+    MLNatural retainCountAndFlags;
+    MLInteger capacity;
+    MLInteger length;
     char* characters;
 };
 
@@ -149,9 +328,30 @@ struct MLDictionary {
     MLNatural retainCountAndFlags;
     MLInteger capacity;
     MLInteger count;
+    MLInteger tombstones;
     MLNatural mask;
     MLNatural hash;
     MLVariable* entries;
+    MLNatural maskOld;
+    MLNatural migrated;
+    MLVariable* entriesOld;
+    MLNatural mutations;
+    MLInteger* shares;
+};
+
+struct MLTrieNode {
+    MLNatural retainCount;
+    MLNatural bitmap;
+    MLNatural count;
+    MLVariable slots[];
+};
+
+struct MLPersistentDictionary {
+    struct MLMeta* meta;
+    MLNatural retainCountAndFlags;
+    MLInteger count;
+    MLNatural hash;
+    struct MLTrieNode* root;
 };
 
 struct MLException {
@@ -169,17 +369,131 @@ struct MLCollectBlock {
     MLVariable* objects;
 };
 
-struct MLPerformHandleBlock {
-    struct MLPerformHandleBlock* previousPerformHandleBlock;
-    jmp_buf destination;
+// Memory unlinked from a lock-free structure, freed once no thread can
+// still be reading it.
+struct MLRetired {
+    struct MLRetired* next;
+    MLNatural epoch;
+    void* pointer;
+    void (*reclaim)(void*);
+};
+
+// One per thread, `state` is (epoch << 1) | 1 while the thread is inside a
+// critical section and 0 otherwise. Records of exited threads are reused.
+struct MLEpochRecord {
+    struct MLEpochRecord* next;
+    MLNatural state;
+    bool isUsed;
+    MLNatural retiredCount;
+    struct MLRetired* retired;
+};
+
+struct MLInternBuckets {
+    MLNatural mask;
+    struct MLString* slots[];
+};
+
+// Slots are MLZero when empty, MLMore when the string was removed. Readers
+// probe without locking, writers hold the shard's lock.
+struct MLInternShard {
+    pthread_mutex_t lock;
+    struct MLInternBuckets* buckets;
+    MLNatural count;
+    MLNatural tombstones;
+} __attribute__((aligned(64)));
+
+// A parallel operation over the objects of an array. `function` runs on a
+// range of them, `results` has a slot per object, or one per chunk when
+// reducing, and `remaining` counts the objects not yet done.
+struct MLJob {
+    void (*function)(struct MLJob* job, MLInteger start, MLInteger end);
+    struct MLArray* array;
+    MLVariable block;
+    MLCode code;
+    MLVariable* results;
+    void* context;
+    MLInteger chunkCount;
+    MLInteger remaining;
     MLVariable exception;
-    bool raised;
+};
+
+// What gets sorted: the object and, on the fast paths, its key pulled out of
+// the object up front so comparisons don't have to dispatch.
+struct MLSortEntry {
+    union {
+        double number;
+        char const* characters;
+    };
+    MLInteger length;
+    MLVariable object;
+};
+
+// A sort job's context. Chunks are sorted from `source` into place first,
+// then pairs of sorted ranges `width` wide are merged from `source` into
+// `target`, a round at a time.
+struct MLSort {
+    void (*sortRange)(struct MLSort* sort, struct MLSortEntry* entries, struct MLSortEntry* scratch, MLInteger count);
+    void (*mergeRange)(struct MLSort* sort, struct MLSortEntry const* left, MLInteger leftCount, struct MLSortEntry const* right, MLInteger rightCount, MLInteger start, MLInteger end, struct MLSortEntry* target);
+    MLVariable block;
+    MLCode code;
+    struct MLSortEntry* source;
+    struct MLSortEntry* target;
+    MLInteger width;
+    MLInteger count;
+};
+
+// A range of a job, run by whichever worker gets to it first.
+struct MLTask {
+    struct MLTask* next;
+    struct MLJob* job;
+    MLInteger start;
+    MLInteger end;
+};
+
+// Chase-Lev work-stealing deque: its worker pushes and pops tasks at the
+// bottom, the other workers steal them from the top.
+struct MLDeque {
+    MLInteger top;
+    MLInteger bottom;
+    struct MLTask** tasks;
+} __attribute__((aligned(64)));
+
+struct MLWorker {
+    struct MLDeque deque;
+    pthread_t thread;
+    unsigned seed;
+};
+
+// Jobs submitted from outside the pool wait in `injected` until a worker
+// picks them up. Idle workers sleep on `wake`, submitters on `finished`.
+struct MLPool {
+    MLInteger count;
+    struct MLWorker* workers;
+    struct MLTask* injected;
+    MLInteger sleepers;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t finished;
+};
+
+// The eventual result of a block spawned on the pool, its job runs the block
+// on `argument` once.
+struct MLFuture {
+    struct MLMeta* meta;
+    MLNatural retainCountAndFlags;
+    struct MLJob job;
+    MLVariable argument;
+    MLVariable result;
 };
 
 // ---------------------------------------------------------------- Types ------
 
 typedef MLNatural (*MLHashFunction)(MLNatural);
 typedef bool (*MLEqualsFunction)(MLNatural, MLNatural);
+typedef MLInteger (*MLCodecKernel)(uint8_t const*, MLInteger, uint8_t*);
+typedef double MLDecimalVector __attribute__((vector_size(32)));
+typedef int64_t MLIntegerVector __attribute__((vector_size(32)));
+typedef int64_t MLVectorMask __attribute__((vector_size(32)));
 
 // ------------------------------------------------------------ Variables ------
 
@@ -189,9 +503,13 @@ static struct MLMeta MLNumberMeta;
 static struct MLMeta MLBlockMeta;
 static struct MLMeta MLDataMeta;
 static struct MLMeta MLArrayMeta;
+static struct MLMeta MLNumberArrayMeta;
 static struct MLMeta MLStringMeta;
+static struct MLMeta MLStringBuilderMeta;
 static struct MLMeta MLDictionaryMeta;
+static struct MLMeta MLPersistentDictionaryMeta;
 static struct MLMeta MLExceptionMeta;
+static struct MLMeta MLFutureMeta;
 static struct MLMeta MLNullMeta;
 
 static struct MLObject MLObjectState = {.meta = &MLObjectMeta, .retainCountAndFlags = MLRetainCountMax};
@@ -200,9 +518,13 @@ static struct MLNumber MLNumberState = {.meta = &MLNumberMeta, .retainCountAndFl
 static struct MLBlock MLBlockState = {.meta = &MLBlockMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLData MLDataState = {.meta = &MLDataMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLArray MLArrayState = {.meta = &MLArrayMeta, .retainCountAndFlags = MLRetainCountMax};
+static struct MLNumberArray MLNumberArrayState = {.meta = &MLNumberArrayMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLString MLStringState = {.meta = &MLStringMeta, .retainCountAndFlags = MLRetainCountMax};
+static struct MLStringBuilder MLStringBuilderState = {.meta = &MLStringBuilderMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLDictionary MLDictionaryState = {.meta = &MLDictionaryMeta, .retainCountAndFlags = MLRetainCountMax};
+static struct MLPersistentDictionary MLPersistentDictionaryState = {.meta = &MLPersistentDictionaryMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLException MLExceptionState = {.meta = &MLExceptionMeta, .retainCountAndFlags = MLRetainCountMax};
+static struct MLFuture MLFutureState = {.meta = &MLFutureMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLObject MLNullState = {.meta = &MLNullMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLBoolean MLYesState = {.meta = &MLBooleanMeta, .retainCountAndFlags = MLRetainCountMax};
 static struct MLBoolean MLNoState = {.meta = &MLBooleanMeta, .retainCountAndFlags = MLRetainCountMax};
@@ -213,17 +535,39 @@ MLVariable const MLNumber = &MLNumberState;
 MLVariable const MLBlock = &MLBlockState;
 MLVariable const MLData = &MLDataState;
 MLVariable const MLArray = &MLArrayState;
+MLVariable const MLNumberArray = &MLNumberArrayState;
 MLVariable const MLString = &MLStringState;
+MLVariable const MLStringBuilder = &MLStringBuilderState;
 MLVariable const MLDictionary = &MLDictionaryState;
+MLVariable const MLPersistentDictionary = &MLPersistentDictionaryState;
 MLVariable const MLException = &MLExceptionState;
+MLVariable const MLFuture = &MLFutureState;
 MLVariable const MLNull = &MLNullState;
 MLVariable const MLYes = &MLYesState;
 MLVariable const MLNo = &MLNoState;
 
-static struct MLCollectBlock* MLCollectBlockTop = MLZero;
-static struct MLPerformHandleBlock* MLPerformHandleBlockTop = MLZero;
+static __thread struct MLCollectBlock* MLCollectBlockTop = MLZero;
+static __thread struct MLPerformHandleBlock* MLPerformHandleBlockTop = MLZero;
 
-static struct MLTable MLStringTable = {.mask = 0, .count = 0, .probeMax = 0, .entries = MLZero};
+static struct MLPool MLThreadPool;
+static pthread_once_t MLThreadPoolOnce = PTHREAD_ONCE_INIT;
+static __thread struct MLWorker* MLPoolThreadWorker = MLZero;
+
+static struct MLInternShard MLInternTable[1 << 6];
+
+static MLNatural MLEpochGlobal = 0;
+static struct MLEpochRecord* MLEpochRecords = MLZero;
+static pthread_key_t MLEpochRecordKey;
+static __thread struct MLEpochRecord* MLEpochThreadRecord = MLZero;
+
+static MLCodecKernel MLBase64EncodeKernel = MLZero;
+static MLCodecKernel MLBase64DecodeKernel = MLZero;
+static MLCodecKernel MLHexEncodeKernel = MLZero;
+static MLCodecKernel MLHexDecodeKernel = MLZero;
+static int8_t MLBase64Values[256];
+
+// Eternal numbers for every byte value, handed out when enumerating data.
+static struct MLNumber MLByteNumbers[256];
 
 static struct MLString* MLObjectClassName = MLZero;
 static struct MLString* MLBooleanClassName = MLZero;
@@ -231,650 +575,3329 @@ static struct MLString* MLNumberClassName = MLZero;
 static struct MLString* MLBlockClassName = MLZero;
 static struct MLString* MLDataClassName = MLZero;
 static struct MLString* MLArrayClassName = MLZero;
+static struct MLString* MLNumberArrayClassName = MLZero;
 static struct MLString* MLStringClassName = MLZero;
+static struct MLString* MLStringBuilderClassName = MLZero;
 static struct MLString* MLDictionaryClassName = MLZero;
+static struct MLString* MLPersistentDictionaryClassName = MLZero;
 static struct MLString* MLExceptionClassName = MLZero;
+static struct MLString* MLFutureClassName = MLZero;
 static struct MLString* MLNullClassName = MLZero;
 static struct MLString* MLNoAsString = MLZero;
 static struct MLString* MLYesAsString = MLZero;
+static struct MLString* MLFutureInstanceAsString = MLZero;
 
 static struct MLString* MLInvalidArgumentException = MLZero;
 static struct MLString* MLInternalInconsistencyException = MLZero;
 
 // ---------------------------------------------------- Helper Functions -------
 
+static void MLRetainMany(MLInteger count, MLVariable const* objects);
+static void MLReleaseMany(MLInteger count, MLVariable const* objects);
 static void MLDataEnsureCapacity(struct MLData* data, MLInteger requiredCapacity);
 static void MLArrayEnsureCapacity(struct MLArray* array, MLInteger requiredCapacity);
+static void MLArrayEnsureHead(struct MLArray* array, MLInteger requiredHead);
+static void MLArrayDetach(struct MLArray* array);
+static void MLNumberArrayEnsureCapacity(struct MLNumberArray* array, MLInteger requiredCapacity);
 static void MLStringEnsureCapacity(struct MLString* string, MLInteger requiredCapacity);
+static void MLStringBuilderEnsureCapacity(struct MLStringBuilder* builder, MLInteger requiredCapacity);
+static void MLStringBuilderAppendCharacters(struct MLStringBuilder* builder, MLInteger length, char const* characters);
 static void MLDictionaryEnsureCapacity(struct MLDictionary* dictionary, MLInteger requiredCapacity);
+static void MLDictionaryResize(struct MLDictionary* dictionary, MLInteger capacity);
+static void MLDictionaryDetach(struct MLDictionary* dictionary);
+static void MLDictionaryMigrate(struct MLDictionary* dictionary, MLNatural steps);
+static MLInteger MLDictionaryFind(MLVariable* entries, MLNatural mask, MLNatural hash, MLVariable key);
+static void MLDictionaryInsert(struct MLDictionary* dictionary, MLNatural hash, MLVariable key, MLVariable value);
 static inline MLNatural MLRoundUpToPowerOfTwo(MLNatural number);
 static inline MLNatural MLRoundDownToPowerOfTwo(MLNatural number);
-static inline MLNatural MLStringHashFunction(MLNatural key);
-static inline bool MLStringEqualsFunction(MLNatural key1, MLNatural key2);
+static void MLStringReclaim(void* string);
+static inline MLNatural MLDataHashValue(struct MLData* data);
+static inline MLNatural MLStringHashValue(struct MLString* string);
+static MLNatural MLArrayHashValue(struct MLArray* array);
+static MLNatural MLDictionaryHashValue(struct MLDictionary* dictionary);
+static MLNatural MLTrieHashValue(struct MLTrieNode* node);
 static MLNatural MLDigest(MLInteger count, const void* bytes);
+static inline uint64_t MLDigestMix(uint64_t value1, uint64_t value2);
+static struct MLString* MLStringTake(MLInteger length, char* characters);
+static struct MLData* MLDataTake(MLInteger count, void* bytes);
+static struct MLArray* MLArrayTake(MLInteger count, MLVariable* objects);
+static void* MLPoolWorkerMain(void* argument);
 
 // ------------------------------------------------- Hash Table Functions ------
 
+static inline struct MLEntry* MLTableAllocate(MLNatural capacity, uint8_t** probes) {
+    struct MLEntry* entries = calloc(1, capacity * (sizeof(struct MLEntry) + sizeof(uint8_t)));
+    *probes = (uint8_t*)(entries + capacity);
+    return entries;
+}
+
 static inline struct MLTable* MLTableCreate(struct MLTable* table, MLNatural capacity) {
-    capacity = MLRoundUpToPowerOfTwo(capacity);
+    capacity = MLRoundUpToPowerOfTwo(MLMax(capacity, 1));
     table->mask = capacity - 1;
     table->count = 0;
     table->probeMax = 0;
-    table->entries = calloc(capacity, sizeof(struct MLEntry));
+    table->entries = MLTableAllocate(capacity, &table->probes);
+    table->maskOld = 0;
+    table->probeMaxOld = 0;
+    table->migrated = 0;
+    table->entriesOld = MLZero;
+    table->probesOld = MLZero;
     return table;
 }
 
 static inline struct MLTable* MLTableDestroy(struct MLTable* table) {
     free(table->entries);
+    free(table->entriesOld);
     memset(table, 0, sizeof(struct MLTable));
     return table;
 }
 
-static inline MLNatural MLTableGet(struct MLTable* table, struct MLEntry* entry, MLHashFunction hashFunction, MLEqualsFunction equalsFunction) {
-    MLNatural const key = entry->key;
-    MLNatural const mask = table->mask;
-    MLNatural const count = table->count;
-    MLNatural const probeMax = table->probeMax;
-    struct MLEntry* const entries = table->entries;
-    MLNatural const hash = hashFunction ? hashFunction(key) : key;
+// Keys of tables without a hash function are pointers, whose low bits are
+// always zero, so they are mixed before being used as a hash.
+static inline MLNatural MLTableHash(MLNatural key, MLHashFunction hashFunction) {
+    if (hashFunction) return hashFunction(key);
 
-    for (MLNatural probe = 1, index = hash & mask; probe <= probeMax; ({ probe += 1; index = (index + 1) & mask; })) {
-        struct MLEntry const current = entries[index];
-        bool const isEmpty = current.probe == 0;
-        bool const isFound = !isEmpty && (equalsFunction ? equalsFunction(key, current.key) : key == current.key);
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
 
-        if (isFound) {
-            *entry = current;
-            return index;
-        }
+static inline MLNatural MLTableFind(struct MLEntry* entries, uint8_t* probes, MLNatural mask, MLNatural probeMax, MLNatural key, MLNatural hash, MLEqualsFunction equalsFunction) {
+    for (MLNatural probe = 1, index = hash & mask; probe <= probeMax; ({ probe += 1; index = (index + 1) & mask; })) {
+        bool const isEmpty = probes[index] == 0;
+        bool const isFound = !isEmpty && (equalsFunction ? equalsFunction(key, entries[index].key) : key == entries[index].key);
+        if (isFound) return index;
     }
 
     return MLNaturalMax;
 }
 
-static inline MLNatural MLTablePut(struct MLTable* table, struct MLEntry* entry, MLHashFunction hashFunction, MLEqualsFunction equalsFunction) {
-    MLNatural const key = entry->key;
-    MLNatural const value = entry->value;
+// Robin hood insertion of an entry whose key is known to be absent, returns
+// the index the entry ended up at. Probe distances beyond what fits into a
+// byte are stored saturated and recomputed from the hash when needed.
+static inline MLNatural MLTableInsert(struct MLEntry* entries, uint8_t* probes, MLNatural mask, MLNatural* probeMax, struct MLEntry entry, MLNatural hash, MLHashFunction hashFunction) {
+    MLNatural placedAt = MLNaturalMax;
 
-    bool const shouldInsert = value != 0;
-    bool const shouldRemove = value == 0;
+    for (MLNatural probe = 1, index = hash & mask; true; ({ probe += 1; index = (index + 1) & mask; })) {
+        struct MLEntry const current = entries[index];
+        MLNatural currentProbe = probes[index];
+        bool const isEmpty = currentProbe == 0;
 
-    MLNatural const quarterOfCapacity = (table->mask + 1) >> 2;
-    bool const isNearlyFull = table->count > quarterOfCapacity + (quarterOfCapacity << 1);
-    bool const isNearlyEmpty = table->count < quarterOfCapacity;
-    bool const shouldExpand = shouldInsert & isNearlyFull;
-    bool const shouldContract = shouldRemove & isNearlyEmpty;
+        if (currentProbe == MLTableProbeSaturated) {
+            currentProbe = ((index - (MLTableHash(current.key, hashFunction) & mask)) & mask) + 1;
+        }
 
-    if (shouldExpand) {
-        MLNatural const capacityOld = table->mask + 1;
-        MLNatural const capacityNew = capacityOld << 1;
+        bool const needsSwap = currentProbe < probe;
 
-        struct MLEntry* const entriesOld = table->entries;
-        struct MLEntry* const entriesNew = calloc(capacityNew, sizeof(struct MLEntry));
+        if (isEmpty || needsSwap) {
+            entries[index] = entry;
+            probes[index] = MLMin(probe, MLTableProbeSaturated);
+            *probeMax = MLMax(*probeMax, probe);
+            if (placedAt == MLNaturalMax) placedAt = index;
+        }
 
-        table->mask = capacityNew - 1;
-        table->count = 0;
-        table->probeMax = 0;
-        table->entries = entriesNew;
+        if (isEmpty) return placedAt;
 
-        for (MLNatural index = 0; index < capacityOld; index += 1) {
-            struct MLEntry current = entriesOld[index];
-            if (current.probe == 0) continue;
-            MLTablePut(table, &current, hashFunction, equalsFunction);
+        if (needsSwap) {
+            entry = current;
+            probe = currentProbe;
         }
+    }
+}
+
+// Moves up to `steps` buckets of the old entries over to the new ones, and
+// frees the old entries once all of them have been moved.
+static void MLTableMigrate(struct MLTable* table, MLNatural steps, MLHashFunction hashFunction) {
+    if (table->entriesOld == MLZero) return;
 
-        free(entriesOld);
+    MLNatural const capacityOld = table->maskOld + 1;
+    MLNatural const end = MLMin(table->migrated + steps, capacityOld);
+
+    for (MLNatural index = table->migrated; index < end; index += 1) {
+        if (table->probesOld[index] == 0) continue;
+        struct MLEntry const current = table->entriesOld[index];
+        MLNatural const hash = MLTableHash(current.key, hashFunction);
+        MLTableInsert(table->entries, table->probes, table->mask, &table->probeMax, current, hash, hashFunction);
+        table->probesOld[index] = 0;
     }
 
-    if (shouldContract) {
-        MLNatural const capacityOld = table->mask + 1;
-        MLNatural const capacityNew = capacityOld >> 1;
+    table->migrated = end;
+    if (end < capacityOld) return;
+
+    free(table->entriesOld);
+    table->entriesOld = MLZero;
+    table->probesOld = MLZero;
+    table->maskOld = 0;
+    table->probeMaxOld = 0;
+    table->migrated = 0;
+}
 
-        struct MLEntry* const entriesOld = table->entries;
-        struct MLEntry* const entriesNew = calloc(capacityNew, sizeof(struct MLEntry));
+// Starts migrating to a table with the new capacity. Entries are moved over
+// incrementally by subsequent puts, so no single put pays for a full rehash.
+static void MLTableResize(struct MLTable* table, MLNatural capacity, MLHashFunction hashFunction) {
+    MLTableMigrate(table, MLNaturalMax, hashFunction);
 
-        table->mask = capacityNew - 1;
-        table->count = 0;
-        table->probeMax = 0;
-        table->entries = entriesNew;
+    table->maskOld = table->mask;
+    table->probeMaxOld = table->probeMax;
+    table->migrated = 0;
+    table->entriesOld = table->entries;
+    table->probesOld = table->probes;
 
-        for (MLNatural index = 0; index < capacityOld; index += 1) {
-            struct MLEntry current = entriesOld[index];
-            if (current.probe == 0) continue;
-            MLTablePut(table, &current, hashFunction, equalsFunction);
-        }
+    table->mask = capacity - 1;
+    table->probeMax = 0;
+    table->entries = MLTableAllocate(capacity, &table->probes);
+}
+
+static inline MLNatural MLTableGet(struct MLTable* table, struct MLEntry* entry, MLHashFunction hashFunction, MLEqualsFunction equalsFunction) {
+    MLNatural const key = entry->key;
+    MLNatural const hash = MLTableHash(key, hashFunction);
 
-        free(entriesOld);
+    MLNatural index = MLTableFind(table->entries, table->probes, table->mask, table->probeMax, key, hash, equalsFunction);
+    if (index != MLNaturalMax) {
+        *entry = table->entries[index];
+        return index;
     }
 
-    MLNatural const mask = table->mask;
-    MLNatural const count = table->count;
-    MLNatural const probeMax = table->probeMax;
-    struct MLEntry* const entries = table->entries;
-    MLNatural const hash = hashFunction ? hashFunction(key) : key;
+    if (table->entriesOld == MLZero) return MLNaturalMax;
 
-    for (MLNatural probe = 1, index = hash & mask; true; ({ probe += 1; index = (index + 1) & mask; })) {
-        struct MLEntry const current = entries[index];
-        bool const isEmpty = current.probe == 0;
-        bool const isFound = !isEmpty && (equalsFunction ? equalsFunction(key, current.key) : entry->key == current.key);
-        bool const needsSwap = current.probe < probe;
-
-        if (shouldInsert && isEmpty) {
-            table->count += 1;
-            table->probeMax = MLMax(table->probeMax, probe);
-            entries[index] = *entry;
-            entries[index].probe = probe;
-            entry->key = 0;
-            entry->value = 0;
-            entry->extra = 0;
-            return index;
-        }
+    index = MLTableFind(table->entriesOld, table->probesOld, table->maskOld, table->probeMaxOld, key, hash, equalsFunction);
+    if (index != MLNaturalMax) {
+        *entry = table->entriesOld[index];
+        return index;
+    }
 
-        if (shouldInsert && isFound) {
-            table->probeMax = MLMax(table->probeMax, probe);
-            entries[index] = *entry;
-            entries[index].probe = probe;
-            *entry = current;
-            return index;
-        }
+    return MLNaturalMax;
+}
 
-        if (shouldInsert && needsSwap) {
-            entries[index] = *entry;
-            entries[index].probe = probe;
-            *entry = current;
-            probe = current.probe;
-            continue;
+static inline MLNatural MLTablePut(struct MLTable* table, struct MLEntry* entry, MLHashFunction hashFunction, MLEqualsFunction equalsFunction) {
+    MLNatural const key = entry->key;
+    MLNatural const value = entry->value;
+    MLNatural const hash = MLTableHash(key, hashFunction);
+
+    bool const shouldInsert = value != 0;
+    bool const shouldRemove = value == 0;
+
+    MLTableMigrate(table, MLTableMigrationSteps, hashFunction);
+
+    // Replace or remove an existing entry, wherever it currently lives:
+    struct MLEntry* entries = table->entries;
+    uint8_t* probes = table->probes;
+    MLNatural index = MLTableFind(entries, probes, table->mask, table->probeMax, key, hash, equalsFunction);
+
+    if (index == MLNaturalMax && table->entriesOld != MLZero) {
+        entries = table->entriesOld;
+        probes = table->probesOld;
+        index = MLTableFind(entries, probes, table->maskOld, table->probeMaxOld, key, hash, equalsFunction);
+    }
+
+    if (index != MLNaturalMax) {
+        struct MLEntry const current = entries[index];
+
+        if (shouldInsert) {
+            entries[index].key = key;
+            entries[index].value = value;
         }
 
-        if (shouldRemove && isFound) {
+        if (shouldRemove) {
             table->count -= 1;
-            entries[index].probe = 0;
+            probes[index] = 0;
             entries[index].key = 0;
             entries[index].value = 0;
-            entries[index].extra = 0;
-            *entry = current;
-            return index;
         }
 
-        if (shouldRemove && probe >= probeMax) {
-            entry->key = 0;
-            entry->value = 0;
-            entry->extra = 0;
-            break;
-        }
+        *entry = current;
     }
 
-    return MLNaturalMax;
-}
+    if (index == MLNaturalMax && shouldInsert) {
+        MLNatural const capacity = table->mask + 1;
+        MLNatural const quarterOfCapacity = capacity >> 2;
+        bool const isNearlyFull = table->count > quarterOfCapacity + (quarterOfCapacity << 1);
+        if (isNearlyFull) MLTableResize(table, capacity << 1, hashFunction);
 
-// ------------------------------------------------------- Object Methods ------
+        struct MLEntry const current = {.key = key, .value = value};
+        index = MLTableInsert(table->entries, table->probes, table->mask, &table->probeMax, current, hash, hashFunction);
+        table->count += 1;
 
-static MLVariable MLObjectAllocate(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return calloc(1, self->meta->size);
+        entry->key = 0;
+        entry->value = 0;
+    }
+    else if (index == MLNaturalMax) {
+        entry->key = 0;
+        entry->value = 0;
+    }
+
+    // Only contract once the table is nearly empty, well below the load a
+    // contracted table would have, so that growing and shrinking can't thrash:
+    if (shouldRemove && table->entriesOld == MLZero) {
+        MLNatural const capacity = table->mask + 1;
+        bool const isNearlyEmpty = table->count < (capacity >> 3);
+        if (isNearlyEmpty && capacity > MLTableMinimumCapacity) MLTableResize(table, capacity >> 1, hashFunction);
+    }
+
+    return index;
 }
 
-static MLVariable MLObjectCreate(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLVariable mutable = MLOption("mutable", MLNo);
-    MLVariable copy = MLOption("copy", MLNull);
+// ------------------------------------------------------ Epoch Functions ------
 
-    if (copy != MLNull) {
-        MLSend(self, "fail*", MLString("InvalidOptionException | Can't create a copy of X"));
-        return MLNull;
-    }
+static void MLEpochThreadExit(void* record) {
+    struct MLEpochRecord* const epochRecord = record;
+    __atomic_store_n(&epochRecord->state, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&epochRecord->isUsed, false, __ATOMIC_RELEASE);
+}
 
-    struct MLMeta* meta = self->meta;
-    struct MLObject* object = self;
+static struct MLEpochRecord* MLEpochRecordForThread() {
+    if (MLEpochThreadRecord != MLZero) return MLEpochThreadRecord;
 
-    if (object->retainCountAndFlags >= MLRetainCountOne) {
-        object = MLSend(self, "allocate", MLOptions(MLString("mutable"), mutable));
-        object->meta = meta;
+    struct MLEpochRecord* record = __atomic_load_n(&MLEpochRecords, __ATOMIC_ACQUIRE);
+    for (; record != MLZero; record = record->next) {
+        bool expected = false;
+        if (__atomic_compare_exchange_n(&record->isUsed, &expected, true, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) break;
     }
 
-    object->retainCountAndFlags = MLRetainCountOne;
-    if (mutable == MLYes) object->retainCountAndFlags |= MLMutableFlag;
+    if (record == MLZero) {
+        record = calloc(1, sizeof(struct MLEpochRecord));
+        record->isUsed = true;
+        record->next = __atomic_load_n(&MLEpochRecords, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&MLEpochRecords, &record->next, record, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
 
-    return MLSend(object, "collect");
+    pthread_setspecific(MLEpochRecordKey, record);
+    MLEpochThreadRecord = record;
+    return record;
 }
 
-static MLVariable MLObjectDestroy(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    free(self);
-    return MLNull;
+// Marks the start of a critical section, memory retired after this point is
+// not reclaimed until the thread leaves it again.
+static inline void MLEpochEnter() {
+    struct MLEpochRecord* const record = MLEpochRecordForThread();
+    MLNatural const epoch = __atomic_load_n(&MLEpochGlobal, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->state, (epoch << 1) | 1, __ATOMIC_SEQ_CST);
 }
 
-static MLVariable MLObjectRetain(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self->retainCountAndFlags < MLRetainCountMax) self->retainCountAndFlags += MLRetainCountOne;
-    return self;
+static inline void MLEpochLeave() {
+    __atomic_store_n(&MLEpochThreadRecord->state, 0, __ATOMIC_RELEASE);
 }
 
-static MLVariable MLObjectRelease(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLNatural const retainCountAndFlags = self->retainCountAndFlags;
+// Advances the global epoch if every thread inside a critical section has
+// observed the current one, returns the (possibly advanced) global epoch.
+static MLNatural MLEpochTryAdvance() {
+    MLNatural epoch = __atomic_load_n(&MLEpochGlobal, __ATOMIC_SEQ_CST);
 
-    if (retainCountAndFlags >= MLRetainCountMax) {
-        return self;
+    for (struct MLEpochRecord* record = __atomic_load_n(&MLEpochRecords, __ATOMIC_ACQUIRE); record != MLZero; record = record->next) {
+        MLNatural const state = __atomic_load_n(&record->state, __ATOMIC_SEQ_CST);
+        bool const isActive = (state & 1) != 0;
+        if (isActive && (state >> 1) != epoch) return epoch;
     }
 
-    else if (retainCountAndFlags >= 2 * MLRetainCountOne) {
-        self->retainCountAndFlags -= MLRetainCountOne;
-        return self;
-    }
+    __atomic_compare_exchange_n(&MLEpochGlobal, &epoch, epoch + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&MLEpochGlobal, __ATOMIC_SEQ_CST);
+}
 
-    else if (retainCountAndFlags >= MLRetainCountOne) {
-        self->retainCountAndFlags -= MLRetainCountOne;
-        return MLSend(self, "destroy");
-    }
+// Reclaims the thread's retired memory that is at least two epochs old, no
+// thread can hold a reference to it anymore.
+static void MLEpochReclaim(struct MLEpochRecord* record) {
+    MLNatural const epoch = MLEpochTryAdvance();
+    struct MLRetired** link = &record->retired;
 
-    else {
-        fprintf(stderr, "[WARNING] Released an object with retain count 0, retain/release calls seem to be unbalanced, aborting ...\n");
-        return MLNull;
+    while (*link != MLZero) {
+        struct MLRetired* const retired = *link;
+
+        if (retired->epoch + 2 > epoch) {
+            link = &retired->next;
+            continue;
+        }
+
+        *link = retired->next;
+        retired->reclaim(retired->pointer);
+        record->retiredCount -= 1;
+        free(retired);
     }
 }
 
-static MLVariable MLObjectCollect(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return MLCollectBlockAdd(self);
-}
+static void MLEpochRetire(void* pointer, void (*reclaim)(void*)) {
+    struct MLEpochRecord* const record = MLEpochRecordForThread();
 
-static MLVariable MLObjectEternize(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    self->retainCountAndFlags = MLRetainCountMax;
-    return self;
-}
+    struct MLRetired* retired = malloc(sizeof(struct MLRetired));
+    retired->pointer = pointer;
+    retired->reclaim = reclaim;
+    retired->epoch = __atomic_load_n(&MLEpochGlobal, __ATOMIC_SEQ_CST);
+    retired->next = record->retired;
 
-static MLVariable MLObjectIsKindOf(struct MLObject* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
-    MLVariable proto = self;
-    do {
-        if (proto == object) return MLYes;
-        proto = MLSend(proto, "proto");
-    } while (proto != MLNull);
-    return MLNo;
-}
+    record->retired = retired;
+    record->retiredCount += 1;
 
-static MLVariable MLObjectIsMutable(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    bool const isMutable = self->retainCountAndFlags & MLMutableFlag;
-    return MLBoolean(isMutable);
+    if (record->retiredCount % MLEpochReclaimInterval == 0) MLEpochReclaim(record);
 }
 
-static MLVariable MLObjectRespondsTo(struct MLObject* self, MLVariable super, MLVariable command, MLVariable commandToCheck, MLVariable options, ...) {
-    // TODO: optimize.
-    MLVariable lookedUpSuper = MLZero;
-    void* code = MLLookup(self, commandToCheck, &lookedUpSuper);
-    return MLBoolean(code != MLZero);
-}
+// ----------------------------------------------- Intern Table Functions ------
 
-static MLVariable MLObjectAsString(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self == MLObject) return MLObjectClassName;
-    // TODO: put in the address of the object.
-    return MLString("<Object XXX>");
+static inline struct MLInternShard* MLInternShardForHash(MLNatural hash) {
+    return &MLInternTable[hash >> (sizeof(MLNatural) * CHAR_BIT - MLInternShardBits)];
 }
 
-static MLVariable MLObjectSelf(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return self;
+static inline struct MLInternBuckets* MLInternBucketsMake(MLNatural capacity) {
+    struct MLInternBuckets* buckets = calloc(1, sizeof(struct MLInternBuckets) + capacity * sizeof(struct MLString*));
+    buckets->mask = capacity - 1;
+    return buckets;
 }
 
-static MLVariable MLObjectHash(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return MLNumber((MLNatural)self);
-}
+// Retains the string unless it is already being destroyed.
+static inline bool MLStringTryRetain(struct MLString* string) {
+    MLNatural retainCountAndFlags = __atomic_load_n(&string->retainCountAndFlags, __ATOMIC_RELAXED);
 
-static MLVariable MLObjectEquals(struct MLObject* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
-    return MLBooleanMake(self == object);
-}
+    do {
+        if (retainCountAndFlags >= MLRetainCountMax) return true;
+        if (retainCountAndFlags < MLRetainCountOne) return false;
+    } while (!__atomic_compare_exchange_n(&string->retainCountAndFlags, &retainCountAndFlags, retainCountAndFlags + MLRetainCountOne, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
 
-static MLVariable MLObjectAddMethodBlock(struct MLObject* self, MLVariable super, MLVariable command, MLVariable method, MLVariable block, MLVariable options, ...) {
-    if (self->meta->owner != self) {
-        struct MLObject* parent = self->meta->owner;
+    return true;
+}
 
-        self->meta = calloc(1, sizeof(struct MLMeta));
-        self->meta->owner = self;
-        self->meta->parent = parent;
+static inline struct MLString* MLInternBucketsFind(struct MLInternBuckets* buckets, MLInteger length, char const* characters, MLNatural hash) {
+    MLNatural const mask = buckets->mask;
 
-        MLTableCreate(&self->meta->cache, parent->meta->cache.count);
-        MLTableCreate(&self->meta->methods, MLMethodsDefaultCapacity);
-        MLTableCreate(&self->meta->children, MLChildrenDefaultCapacity);
+    for (MLNatural probe = 0, index = hash & mask; probe <= mask; ({ probe += 1; index = (index + 1) & mask; })) {
+        struct MLString* const string = __atomic_load_n(&buckets->slots[index], __ATOMIC_ACQUIRE);
+        if (string == MLZero) return MLZero;
+        if (string == MLMore) continue;
 
-        struct MLEntry entry = {.key = (MLNatural)self, .value = (MLNatural)MLYes, .extra = 0};
-        MLTablePut(&parent->meta->children, &entry, MLZero, MLZero);
+        bool const isEqual = string->hash == hash && string->length == length && memcmp(string->characters, characters, length) == 0;
+        if (isEqual && MLStringTryRetain(string)) return string;
     }
 
-    struct MLEntry entry = {.key = (MLNatural)method, .value = (MLNatural)block(block).code, .extra = 0};
-    MLTablePut(&self->meta->methods, &entry, MLZero, MLZero);
-    MLObjectEternize(method, MLObject, NULL, NULL);
+    return MLZero;
+}
 
-    // TODO: clear cache of all children.
+// Returns the interned string with the given characters retained, or MLZero.
+static struct MLString* MLInternTableGet(MLInteger length, char const* characters, MLNatural hash) {
+    struct MLInternShard* const shard = MLInternShardForHash(hash);
 
-    return self;
-}
+    MLEpochEnter();
+    struct MLInternBuckets* const buckets = __atomic_load_n(&shard->buckets, __ATOMIC_ACQUIRE);
+    struct MLString* const string = MLInternBucketsFind(buckets, length, characters, hash);
+    MLEpochLeave();
 
-static MLVariable MLObjectRemoveMethod(struct MLObject* self, MLVariable super, MLVariable command, MLVariable method, MLVariable options, ...) {
-    // TODO: implement.
-    return MLNull;
+    return string;
 }
 
-static MLVariable MLObjectProto(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    struct MLObject* parent = self->meta->parent;
-    struct MLObject* owner = self->meta->owner;
-    return owner == self ? parent : owner;
-}
+static void MLInternShardRebuild(struct MLInternShard* shard, MLNatural capacity) {
+    struct MLInternBuckets* const oldBuckets = shard->buckets;
+    struct MLInternBuckets* const newBuckets = MLInternBucketsMake(capacity);
 
-static MLVariable MLObjectSetProto(struct MLObject* self, MLVariable super, MLVariable command, MLVariable proto, MLVariable options, ...) {
-    // TODO: implement.
-    return MLNull;
-}
+    shard->count = 0;
+    shard->tombstones = 0;
 
-static MLVariable MLObjectWarn(struct MLObject* self, MLVariable super, MLVariable command, MLVariable message, MLVariable options, ...) {
-    MLVariable description = MLSend(message, "as-string");
-    fprintf(stderr, "[WARNING] %s\n", string(description).characters);
-    return self;
+    for (MLNatural index = 0; index <= oldBuckets->mask; index += 1) {
+        struct MLString* const string = oldBuckets->slots[index];
+        if (string == MLZero || string == MLMore) continue;
+
+        MLNatural slot = string->hash & newBuckets->mask;
+        while (newBuckets->slots[slot] != MLZero) slot = (slot + 1) & newBuckets->mask;
+        newBuckets->slots[slot] = string;
+        shard->count += 1;
+    }
+
+    __atomic_store_n(&shard->buckets, newBuckets, __ATOMIC_RELEASE);
+    MLEpochRetire(oldBuckets, free);
 }
 
-static MLVariable MLObjectFail(struct MLObject* self, MLVariable super, MLVariable command, MLVariable message, MLVariable options, ...) {
-    MLRaise(message);
-    return self;
+// Interns the string, unless another thread interned an equal one first, in
+// which case that one is returned retained instead.
+static struct MLString* MLInternTableAdd(struct MLString* string) {
+    struct MLInternShard* const shard = MLInternShardForHash(string->hash);
+
+    pthread_mutex_lock(&shard->lock);
+
+    struct MLString* const existing = MLInternBucketsFind(shard->buckets, string->length, string->characters, string->hash);
+    if (existing != MLZero) {
+        pthread_mutex_unlock(&shard->lock);
+        return existing;
+    }
+
+    MLNatural const capacity = shard->buckets->mask + 1;
+    bool const isNearlyFull = shard->count + shard->tombstones + 1 > capacity - (capacity >> 2);
+    if (isNearlyFull) MLInternShardRebuild(shard, shard->count + 1 > capacity >> 1 ? capacity << 1 : capacity);
+
+    struct MLInternBuckets* const buckets = shard->buckets;
+    MLNatural index = string->hash & buckets->mask;
+
+    while (buckets->slots[index] != MLZero && buckets->slots[index] != MLMore) index = (index + 1) & buckets->mask;
+    if (buckets->slots[index] == MLMore) shard->tombstones -= 1;
+
+    __atomic_store_n(&buckets->slots[index], string, __ATOMIC_RELEASE);
+    shard->count += 1;
+
+    pthread_mutex_unlock(&shard->lock);
+    return string;
 }
 
-static MLVariable MLObjectDebug(struct MLObject* self, MLVariable super, MLVariable command, MLVariable message, MLVariable options, ...) {
-    MLVariable description = MLSend(message, "as-string");
-    fprintf(stderr, "[DEBUG] %s\n", string(description).characters);
-    return self;
+// Removes exactly this string, an equal string interned after this one
+// started being destroyed stays in place.
+static void MLInternTableRemove(struct MLString* string) {
+    struct MLInternShard* const shard = MLInternShardForHash(string->hash);
+
+    pthread_mutex_lock(&shard->lock);
+
+    struct MLInternBuckets* const buckets = shard->buckets;
+    MLNatural const mask = buckets->mask;
+
+    for (MLNatural probe = 0, index = string->hash & mask; probe <= mask; ({ probe += 1; index = (index + 1) & mask; })) {
+        struct MLString* const current = buckets->slots[index];
+        if (current == MLZero) break;
+        if (current != string) continue;
+
+        __atomic_store_n(&buckets->slots[index], MLMore, __ATOMIC_RELEASE);
+        shard->count -= 1;
+        shard->tombstones += 1;
+        break;
+    }
+
+    MLNatural const capacity = mask + 1;
+    bool const isNearlyEmpty = shard->count < (capacity >> 3);
+    if (isNearlyEmpty && capacity > MLTableMinimumCapacity) MLInternShardRebuild(shard, capacity >> 1);
+
+    pthread_mutex_unlock(&shard->lock);
 }
 
-// ------------------------------------------------------ Boolean Methods ------
+// ------------------------------------------------------- Rope Functions ------
 
-static MLVariable MLBooleanCreate(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLSend(self, "fail*", MLString("InvalidCommandException | Can't create a Boolean"));
-    return MLNull;
+static inline MLInteger MLRopeLength(struct MLRope* rope) {
+    return rope == MLZero ? 0 : rope->length;
 }
 
-static MLVariable MLBooleanDestroy(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLSend(self, "fail*", MLString("InvalidCommandException | Can't destroy a Boolean"));
-    return MLNull;
+static inline struct MLRope* MLRopeUpdate(struct MLRope* rope) {
+    rope->length = MLRopeLength(rope->left) + rope->count + MLRopeLength(rope->right);
+    return rope;
 }
 
-static MLVariable MLBooleanAsString(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self == MLBoolean) return MLBooleanClassName;
-    if (self == MLYes) return MLYesAsString;
-    if (self == MLNo) return MLNoAsString;
+// Priorities are derived from the node's address, which is as good as random
+// for keeping the treap balanced in expectation.
+static inline struct MLRope* MLRopeMakeChunk(MLInteger count, char const* characters) {
+    struct MLRope* rope = malloc(sizeof(struct MLRope) + count);
+    rope->left = MLZero;
+    rope->right = MLZero;
+    rope->priority = MLTableHash((MLNatural)rope, MLZero);
+    rope->length = count;
+    rope->count = count;
+    memcpy(rope->characters, characters, count);
+    return rope;
+}
 
-    MLSend(self, "fail*", MLString("MLInternalInconsistencyException | Can't return boolean as-string, self is neither MLYes, nor MLNo, nor Boolean"));
-    return MLNull;
+static void MLRopeDestroy(struct MLRope* rope) {
+    if (rope == MLZero) return;
+    MLRopeDestroy(rope->left);
+    MLRopeDestroy(rope->right);
+    free(rope);
 }
 
-static MLVariable MLBooleanCompare(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
-    if (self == MLBoolean) return MLNull;
-    if (object != MLYes && object != MLNo) return MLNull;
+static struct MLRope* MLRopeMerge(struct MLRope* rope1, struct MLRope* rope2) {
+    if (rope1 == MLZero) return rope2;
+    if (rope2 == MLZero) return rope1;
 
-    if (self == MLNo && object == MLYes) return MLNumber(-1);
-    if (self == MLYes && object == MLNo) return MLNumber(+1);
+    if (rope1->priority > rope2->priority) {
+        rope1->right = MLRopeMerge(rope1->right, rope2);
+        return MLRopeUpdate(rope1);
+    }
 
-    return MLNumber(0);
+    rope2->left = MLRopeMerge(rope1, rope2->left);
+    return MLRopeUpdate(rope2);
 }
 
-static MLVariable MLBooleanCopy(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return self;
+// Splits the rope into the first `index` characters and the rest, splitting
+// the chunk that straddles `index` if needed.
+static void MLRopeSplit(struct MLRope* rope, MLInteger index, struct MLRope** left, struct MLRope** right) {
+    if (rope == MLZero) {
+        *left = MLZero;
+        *right = MLZero;
+        return;
+    }
+
+    MLInteger const leftLength = MLRopeLength(rope->left);
+
+    if (index <= leftLength) {
+        MLRopeSplit(rope->left, index, left, &rope->left);
+        *right = MLRopeUpdate(rope);
+    }
+
+    else if (index >= leftLength + rope->count) {
+        MLRopeSplit(rope->right, index - leftLength - rope->count, &rope->right, right);
+        *left = MLRopeUpdate(rope);
+    }
+
+    else {
+        MLInteger const offset = index - leftLength;
+        struct MLRope* const head = MLRopeMakeChunk(offset, rope->characters);
+        struct MLRope* const tail = MLRopeMakeChunk(rope->count - offset, rope->characters + offset);
+        *left = MLRopeMerge(rope->left, head);
+        *right = MLRopeMerge(tail, rope->right);
+        free(rope);
+    }
 }
 
-// ------------------------------------------------------- Number Methods ------
+// Merges the ropes like MLRopeMerge, but first joins the last chunk of the
+// first and the first chunk of the second into one if they fit together, so
+// that small edits don't leave ever more tiny chunks behind.
+static struct MLRope* MLRopeConcatenate(struct MLRope* rope1, struct MLRope* rope2) {
+    if (rope1 == MLZero) return rope2;
+    if (rope2 == MLZero) return rope1;
+
+    struct MLRope* last = rope1;
+    struct MLRope* first = rope2;
+    while (last->right != MLZero) last = last->right;
+    while (first->left != MLZero) first = first->left;
+    if (last->count + first->count > MLRopeChunkCapacity) return MLRopeMerge(rope1, rope2);
+
+    // Splitting at chunk boundaries detaches the chunks without copying them:
+    MLRopeSplit(rope1, rope1->length - last->count, &rope1, &last);
+    MLRopeSplit(rope2, first->count, &first, &rope2);
+
+    last = realloc(last, sizeof(struct MLRope) + last->count + first->count);
+    memcpy(last->characters + last->count, first->characters, first->count);
+    last->count += first->count;
+    last->length = last->count;
+    free(first);
+
+    return MLRopeMerge(MLRopeMerge(rope1, last), rope2);
+}
 
-static MLVariable MLNumberCreate(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLSend(self, "fail*", MLString("InvalidCommandException | Can't create a Number"));
-    return MLNull;
+static struct MLRope* MLRopeMake(MLInteger length, char const* characters) {
+    struct MLRope* rope = MLZero;
+
+    for (MLInteger offset = 0; offset < length; offset += MLRopeChunkCapacity) {
+        MLInteger const count = MLMin(MLRopeChunkCapacity, length - offset);
+        rope = MLRopeMerge(rope, MLRopeMakeChunk(count, characters + offset));
+    }
+
+    return rope;
 }
 
-static MLVariable MLNumberAsString(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self == MLNumber) return MLNumberClassName;
+// Copies `count` characters starting at `index` into `destination`.
+static void MLRopeCopy(struct MLRope* rope, MLInteger index, MLInteger count, char* destination) {
+    if (rope == MLZero || count <= 0) return;
 
-    // TODO: tweak to not print trailing MLZeros.
-    MLDecimal MLIntegerPart = 0;
-    MLDecimal fractionalPart = modf(self->number, &MLIntegerPart);
-    MLInteger const bufferSize = 1024 * 1024;
-    char buffer[bufferSize + 1];
-    int length = 0;
+    MLInteger const leftLength = MLRopeLength(rope->left);
 
-    if (fractionalPart == 0) {
-        length = snprintf(buffer, bufferSize + 1, "%li", (MLInteger)self->number);
+    if (index < leftLength) {
+        MLInteger const leftCount = MLMin(count, leftLength - index);
+        MLRopeCopy(rope->left, index, leftCount, destination);
+        destination += leftCount;
+        count -= leftCount;
+        index = leftLength;
     }
-    else {
-        length = snprintf(buffer, bufferSize + 1, "%f", self->number);
+
+    MLInteger const offset = index - leftLength;
+    if (count > 0 && offset < rope->count) {
+        MLInteger const ownCount = MLMin(count, rope->count - offset);
+        memcpy(destination, rope->characters + offset, ownCount);
+        destination += ownCount;
+        count -= ownCount;
+        index += ownCount;
     }
 
-   MLVariable const string = MLStringMake(length, buffer);
-    return MLSend(string, "collect");
+    MLRopeCopy(rope->right, index - leftLength - rope->count, count, destination);
 }
 
-static MLVariable MLNumberHash(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return self;
+// Returns the string's characters, flattening its rope first if it has one.
+static char* MLStringCharacters(struct MLString* string) {
+    if (string->rope == MLZero) return string->characters;
+
+    char* characters = malloc(string->length + 1);
+    MLRopeCopy(string->rope, 0, string->length, characters);
+    characters[string->length] = '\0';
+
+    MLRopeDestroy(string->rope);
+    string->rope = MLZero;
+    string->characters = characters;
+    string->capacity = string->length;
+
+    return characters;
 }
 
-static MLVariable MLNumberEquals(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
-    return MLDecimalFrom(self) == MLDecimalFrom(object) ? MLYes : MLNo;
+// ------------------------------------------------------ Slice Functions ------
+
+// Gives the view its own copy of its bytes and lets go of its parent.
+static void MLBufferMaterialize(struct MLBuffer* view) {
+    struct MLBuffer* const parent = view->parent;
+
+    char* bytes = malloc(view->count + 1);
+    memcpy(bytes, view->bytes, view->count);
+    bytes[view->count] = '\0';
+
+    view->bytes = bytes;
+    view->parent = MLZero;
+    view->viewIndex = -1;
+
+    MLSend(parent, "release");
 }
 
-static MLVariable MLNumberCompare(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
-    MLDecimal const number1 = MLDecimalFrom(self);
-    MLDecimal const number2 = MLDecimalFrom(object);
+// Materializes all views of a mutable buffer that is about to change.
+static void MLBufferMaterializeViews(struct MLBuffer* buffer) {
+    struct MLViews* const views = buffer->views;
+    if (views == MLZero) return;
 
-    if (number1 < number2) return MLNumber(-1);
-    if (number1 > number2) return MLNumber(+1);
+    buffer->views = MLZero;
 
-    return MLNumber(0);
+    for (MLInteger index = 0; index < views->count; index += 1) {
+        MLBufferMaterialize(views->objects[index]);
+    }
+
+    free(views);
 }
 
-static MLVariable MLNumberCopy(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return MLSend(self, "retain");
+// Unregisters a view that is being destroyed from its parent.
+static void MLBufferDetach(struct MLBuffer* view) {
+    struct MLBuffer* const parent = view->parent;
+
+    if (view->viewIndex >= 0) {
+        struct MLViews* const views = parent->views;
+        struct MLBuffer* const last = views->objects[views->count - 1];
+        views->objects[view->viewIndex] = last;
+        last->viewIndex = view->viewIndex;
+        views->count -= 1;
+    }
+
+    MLSend(parent, "release");
 }
 
-// -------------------------------------------------------- Block Methods ------
+// Returns whether a slice should rather be a copy than pin its parent: a
+// small slice of a huge immutable buffer would keep all of it alive.
+static inline bool MLBufferShouldCopySlice(struct MLBuffer* buffer, MLInteger count) {
+    struct MLBuffer* const root = buffer->parent != MLZero ? buffer->parent : buffer;
+    if (count < MLSliceMinimumCount) return true;
+    return root->count >= MLSlicePinCount && count < root->count / MLSlicePinRatio;
+}
 
-static MLVariable MLBlockCreate(struct MLBlock* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLSend(self, "fail*", MLString("InvalidCommandException | Can't create a Block"));
-    return MLNull;
+// Makes a view of `count` bytes at `index` of the buffer, which is created
+// for the root parent if the buffer itself is a view.
+static struct MLBuffer* MLBufferViewMake(struct MLBuffer* buffer, struct MLMeta* meta, MLNatural size, MLInteger index, MLInteger count) {
+    struct MLBuffer* const root = buffer->parent != MLZero ? buffer->parent : buffer;
+
+    struct MLBuffer* view = calloc(1, size);
+    view->meta = meta;
+    view->retainCountAndFlags = MLRetainCountOne;
+    view->capacity = -1;
+    view->count = count;
+    view->hash = 0;
+    view->parent = MLSend(root, "retain");
+    view->viewIndex = -1;
+    view->bytes = buffer->bytes + index;
+
+    if (MLSend(root, "is-mutable") == MLYes) {
+        struct MLViews* views = root->views;
+
+        if (views == MLZero || views->count == views->capacity) {
+            MLInteger const capacity = views == MLZero ? 4 : views->capacity * 2;
+            views = realloc(views, sizeof(struct MLViews) + capacity * sizeof(struct MLBuffer*));
+            if (root->views == MLZero) views->count = 0;
+            views->capacity = capacity;
+            root->views = views;
+        }
+
+        view->viewIndex = views->count;
+        views->objects[views->count] = view;
+        views->count += 1;
+    }
+
+    return view;
 }
 
-static MLVariable MLBlockAsString(struct MLBlock* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self == MLBlock) return MLBlockClassName;
+// ------------------------------------------------------ Share Functions ------
 
-    static struct MLString* string = MLZero;
-    if (string == MLZero) {
-        // TODO: put in the address of the block.
-        string = MLStringUncollected("<Block XXX>");
-        MLSend(string, "eternize");
+// Copies of arrays and dictionaries share their storage until one of them
+// changes. `shares` points to how many objects share it, or is MLZero while
+// an object has its storage to itself. Data and strings use views instead.
+
+// Adds a sharer to the storage of an object, starting the count if needed.
+static MLInteger* MLShareJoin(MLInteger** shares) {
+    MLInteger* current = __atomic_load_n(shares, __ATOMIC_ACQUIRE);
+
+    if (current == MLZero) {
+        MLInteger* const started = malloc(sizeof(MLInteger));
+        *started = 1;
+        if (__atomic_compare_exchange_n(shares, &current, started, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) current = started;
+        else free(started);
     }
-    return string;
+
+    __atomic_add_fetch(current, 1, __ATOMIC_ACQ_REL);
+    return current;
 }
 
-// --------------------------------------------------------- MLData Methods ------
+// Removes a sharer, returns whether it was the last one, which then owns the
+// storage again.
+static bool MLShareLeave(MLInteger** shares) {
+    MLInteger* const current = *shares;
+    if (current == MLZero) return true;
 
-static MLVariable MLDataCreate(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLVariable mutable = MLOption("mutable", MLNo);
-    MLVariable capacity = MLOption("capacity", MLNumber(1));
-    MLVariable copy = MLOption("copy", MLNull);
+    *shares = MLZero;
+    if (__atomic_sub_fetch(current, 1, __ATOMIC_ACQ_REL) > 0) return false;
 
-    // TODO: copy if needed.
+    free(current);
+    return true;
+}
 
-    self = MLSuper(self, "create", MLString("mutable"), mutable);
-    self->capacity = MLIntegerFrom(capacity);
-    self->capacity = MLMax(self->capacity, MLDataDefaultCapacity);
-    self->capacity = MLRoundUpToPowerOfTwo(self->capacity);
-    self->count = 0;
-    self->bytes = calloc(self->capacity, 1);
+// Returns whether the storage is shared with other objects, forgetting the
+// count if it isn't anymore.
+static bool MLShareIsShared(MLInteger** shares) {
+    if (*shares == MLZero) return false;
+    if (__atomic_load_n(*shares, __ATOMIC_ACQUIRE) > 1) return true;
 
-    return self;
+    free(*shares);
+    *shares = MLZero;
+    return false;
 }
 
-static MLVariable MLDataDestroy(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    free(self->bytes);
-    return MLSuper(self, "destroy");
+// ------------------------------------------------------ Codec Functions ------
+
+// Each kernel converts as much of `source` as it can in whole vector blocks
+// and returns how many source bytes it consumed, the scalar loops finish the
+// rest. Decoders stop at the first block with an invalid character. Kernels
+// may write up to MLCodecSlack bytes past the end of what they produce.
+
+static MLInteger MLCodecKernelNone(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    return 0;
 }
 
-static MLVariable MLDataAsString(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self == MLData) return MLDataClassName;
+#if defined(__x86_64__) || defined(__i386__)
 
-    // TODO: implement Base64 encoding.
-    char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    return MLString("<Data XXX>");
+__attribute__((target("ssse3"))) static inline __m128i MLBase64EncodeBlock128(__m128i input) {
+    __m128i const shuffled = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i const high = _mm_mulhi_epu16(_mm_and_si128(shuffled, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+    __m128i const low = _mm_mullo_epi16(_mm_and_si128(shuffled, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+    __m128i const indices = _mm_or_si128(high, low);
+
+    // Offset to add to each 6-bit index, picked by the range it falls in:
+    __m128i const offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
 }
 
-static MLVariable MLDataHash(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLNatural const digest = MLDigest(self->count, self->bytes);
-    return MLNumber((MLDecimal)digest);
+__attribute__((target("avx2"))) static inline __m256i MLBase64EncodeBlock256(__m256i input) {
+    __m256i const shuffled = _mm256_shuffle_epi8(input, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m256i const high = _mm256_mulhi_epu16(_mm256_and_si256(shuffled, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+    __m256i const low = _mm256_mullo_epi16(_mm256_and_si256(shuffled, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+    __m256i const indices = _mm256_or_si256(high, low);
+
+    __m256i const offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+    return _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
 }
 
-static MLVariable MLDataEquals(struct MLData* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
-    if (self == object) return MLYes;
-    if (MLSend(object, "is-kind-of*", MLData) == MLNo) return MLNo;
+__attribute__((target("ssse3"))) static MLInteger MLBase64EncodeSSSE3(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    MLInteger consumed = 0;
+    for (; consumed + 16 <= count; consumed += 12, destination += 16) {
+        __m128i const input = _mm_loadu_si128((__m128i const*)(source + consumed));
+        _mm_storeu_si128((__m128i*)destination, MLBase64EncodeBlock128(input));
+    }
+    return consumed;
+}
 
-    struct MLData* data1 = self;
-    struct MLData* data2 = object;
+__attribute__((target("avx2"))) static MLInteger MLBase64EncodeAVX2(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    MLInteger consumed = 0;
+    for (; consumed + 28 <= count; consumed += 24, destination += 32) {
+        __m128i const first = _mm_loadu_si128((__m128i const*)(source + consumed));
+        __m128i const second = _mm_loadu_si128((__m128i const*)(source + consumed + 12));
+        __m256i const input = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+        _mm256_storeu_si256((__m256i*)destination, MLBase64EncodeBlock256(input));
+    }
+    return consumed + MLBase64EncodeSSSE3(source + consumed, count - consumed, destination);
+}
 
-    if (data1->count != data2->count) return MLNo;
+// Validates and maps characters to 6-bit values by their nibbles (Muła).
+__attribute__((target("ssse3"))) static MLInteger MLBase64DecodeSSSE3(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    __m128i const lowerLookup = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    __m128i const upperLookup = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    __m128i const rollLookup = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i const mask = _mm_set1_epi8(0x2F);
+
+    MLInteger consumed = 0;
+    for (; consumed + 16 <= count; consumed += 16, destination += 12) {
+        __m128i input = _mm_loadu_si128((__m128i const*)(source + consumed));
+        __m128i const upperNibbles = _mm_and_si128(_mm_srli_epi32(input, 4), mask);
+        __m128i const lowerNibbles = _mm_and_si128(input, mask);
+        __m128i const lower = _mm_shuffle_epi8(lowerLookup, lowerNibbles);
+        __m128i const upper = _mm_shuffle_epi8(upperLookup, upperNibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lower, upper), _mm_setzero_si128())) != 0xFFFF) break;
+
+        __m128i const roll = _mm_shuffle_epi8(rollLookup, _mm_add_epi8(_mm_cmpeq_epi8(input, mask), upperNibbles));
+        input = _mm_add_epi8(input, roll);
+
+        // Pack four 6-bit values into three bytes:
+        __m128i const pairs = _mm_maddubs_epi16(input, _mm_set1_epi32(0x01400140));
+        __m128i const words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        __m128i const output = _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i*)destination, output);
+    }
+    return consumed;
+}
 
-    MLInteger const result = memcmp(data1->bytes, data2->bytes, data1->count);
-    return result == 0 ? MLYes : MLNo;
+__attribute__((target("avx2"))) static MLInteger MLBase64DecodeAVX2(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    __m256i const lowerLookup = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    __m256i const upperLookup = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    __m256i const rollLookup = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i const mask = _mm256_set1_epi8(0x2F);
+
+    MLInteger consumed = 0;
+    for (; consumed + 32 <= count; consumed += 32, destination += 24) {
+        __m256i input = _mm256_loadu_si256((__m256i const*)(source + consumed));
+        __m256i const upperNibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask);
+        __m256i const lowerNibbles = _mm256_and_si256(input, mask);
+        __m256i const lower = _mm256_shuffle_epi8(lowerLookup, lowerNibbles);
+        __m256i const upper = _mm256_shuffle_epi8(upperLookup, upperNibbles);
+        if (!_mm256_testz_si256(lower, upper)) break;
+
+        __m256i const roll = _mm256_shuffle_epi8(rollLookup, _mm256_add_epi8(_mm256_cmpeq_epi8(input, mask), upperNibbles));
+        input = _mm256_add_epi8(input, roll);
+
+        __m256i const pairs = _mm256_maddubs_epi16(input, _mm256_set1_epi32(0x01400140));
+        __m256i const words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        __m256i output = _mm256_shuffle_epi8(words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        output = _mm256_permutevar8x32_epi32(output, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256((__m256i*)destination, output);
+    }
+    return consumed + MLBase64DecodeSSSE3(source + consumed, count - consumed, destination);
 }
 
-static MLVariable MLDataCopy(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self->capacity < 0) return MLSend(self, "retain");
-    // TODO: make an immutable copy.
+__attribute__((target("ssse3"))) static MLInteger MLHexEncodeSSSE3(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    __m128i const digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    __m128i const mask = _mm_set1_epi8(0x0F);
+
+    MLInteger consumed = 0;
+    for (; consumed + 16 <= count; consumed += 16, destination += 32) {
+        __m128i const input = _mm_loadu_si128((__m128i const*)(source + consumed));
+        __m128i const upper = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(input, 4), mask));
+        __m128i const lower = _mm_shuffle_epi8(digits, _mm_and_si128(input, mask));
+        _mm_storeu_si128((__m128i*)destination, _mm_unpacklo_epi8(upper, lower));
+        _mm_storeu_si128((__m128i*)(destination + 16), _mm_unpackhi_epi8(upper, lower));
+    }
+    return consumed;
+}
+
+__attribute__((target("avx2"))) static MLInteger MLHexEncodeAVX2(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    __m256i const digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    __m256i const mask = _mm256_set1_epi8(0x0F);
+
+    MLInteger consumed = 0;
+    for (; consumed + 32 <= count; consumed += 32, destination += 64) {
+        __m256i const input = _mm256_loadu_si256((__m256i const*)(source + consumed));
+        __m256i const upper = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(input, 4), mask));
+        __m256i const lower = _mm256_shuffle_epi8(digits, _mm256_and_si256(input, mask));
+        __m256i const first = _mm256_unpacklo_epi8(upper, lower);
+        __m256i const second = _mm256_unpackhi_epi8(upper, lower);
+        _mm256_storeu_si256((__m256i*)destination, _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i*)(destination + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return consumed + MLHexEncodeSSSE3(source + consumed, count - consumed, destination);
+}
+
+__attribute__((target("ssse3"))) static MLInteger MLHexDecodeSSSE3(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    MLInteger consumed = 0;
+    for (; consumed + 16 <= count; consumed += 16, destination += 8) {
+        __m128i const input = _mm_loadu_si128((__m128i const*)(source + consumed));
+        __m128i const digit = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+        __m128i const letter = _mm_sub_epi8(_mm_or_si128(input, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i const isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        __m128i const isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+        if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF) break;
+
+        __m128i const values = _mm_or_si128(_mm_and_si128(isDigit, digit), _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+        __m128i const bytes = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+        _mm_storel_epi64((__m128i*)destination, _mm_packus_epi16(bytes, bytes));
+    }
+    return consumed;
+}
+
+__attribute__((target("avx2"))) static MLInteger MLHexDecodeAVX2(uint8_t const* source, MLInteger count, uint8_t* destination) {
+    MLInteger consumed = 0;
+    for (; consumed + 32 <= count; consumed += 32, destination += 16) {
+        __m256i const input = _mm256_loadu_si256((__m256i const*)(source + consumed));
+        __m256i const digit = _mm256_sub_epi8(input, _mm256_set1_epi8('0'));
+        __m256i const letter = _mm256_sub_epi8(_mm256_or_si256(input, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i const isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i const isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+        if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) != -1) break;
+
+        __m256i const values = _mm256_or_si256(_mm256_and_si256(isDigit, digit), _mm256_and_si256(isLetter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+        __m256i const bytes = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+        __m256i const packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(bytes, bytes), 0x08);
+        _mm_storeu_si128((__m128i*)destination, _mm256_castsi256_si128(packed));
+    }
+    return consumed + MLHexDecodeSSSE3(source + consumed, count - consumed, destination);
+}
+
+#endif
+
+// Fills the Base64 decoding table and picks the widest kernels the CPU
+// supports, called once while bootstrapping.
+static void MLCodecInitialize() {
+    MLBase64EncodeKernel = MLCodecKernelNone;
+    MLBase64DecodeKernel = MLCodecKernelNone;
+    MLHexEncodeKernel = MLCodecKernelNone;
+    MLHexDecodeKernel = MLCodecKernelNone;
+
+    memset(MLBase64Values, -1, sizeof(MLBase64Values));
+    for (int index = 0; index < 64; index += 1) MLBase64Values[(uint8_t)MLBase64Alphabet[index]] = index;
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        MLBase64EncodeKernel = MLBase64EncodeAVX2;
+        MLBase64DecodeKernel = MLBase64DecodeAVX2;
+        MLHexEncodeKernel = MLHexEncodeAVX2;
+        MLHexDecodeKernel = MLHexDecodeAVX2;
+    }
+    else if (__builtin_cpu_supports("ssse3")) {
+        MLBase64EncodeKernel = MLBase64EncodeSSSE3;
+        MLBase64DecodeKernel = MLBase64DecodeSSSE3;
+        MLHexEncodeKernel = MLHexEncodeSSSE3;
+        MLHexDecodeKernel = MLHexDecodeSSSE3;
+    }
+#endif
+}
+
+static MLInteger MLBase64Encode(uint8_t const* source, MLInteger count, char* destination) {
+    MLInteger index = MLBase64EncodeKernel(source, count, (uint8_t*)destination);
+    char* cursor = destination + index / 3 * 4;
+
+    for (; index + 3 <= count; index += 3) {
+        uint32_t const triple = (uint32_t)source[index] << 16 | (uint32_t)source[index + 1] << 8 | source[index + 2];
+        *cursor++ = MLBase64Alphabet[triple >> 18 & 0x3F];
+        *cursor++ = MLBase64Alphabet[triple >> 12 & 0x3F];
+        *cursor++ = MLBase64Alphabet[triple >> 6 & 0x3F];
+        *cursor++ = MLBase64Alphabet[triple & 0x3F];
+    }
+
+    if (index < count) {
+        uint32_t const triple = (uint32_t)source[index] << 16 | (index + 1 < count ? (uint32_t)source[index + 1] << 8 : 0);
+        *cursor++ = MLBase64Alphabet[triple >> 18 & 0x3F];
+        *cursor++ = MLBase64Alphabet[triple >> 12 & 0x3F];
+        *cursor++ = index + 1 < count ? MLBase64Alphabet[triple >> 6 & 0x3F] : '=';
+        *cursor++ = '=';
+    }
+
+    return cursor - destination;
+}
+
+// Returns the count of decoded bytes, or -1 if characters aren't Base64.
+static MLInteger MLBase64Decode(char const* source, MLInteger length, uint8_t* destination) {
+    if (length % 4 != 0) return -1;
+
+    // Padding only ever ends the last quantum:
+    MLInteger padding = 0;
+    if (length > 0 && source[length - 1] == '=') padding += 1;
+    if (length > 1 && source[length - 2] == '=') padding += 1;
+
+    MLInteger const unpadded = length - (padding > 0 ? 4 : 0);
+    MLInteger index = MLBase64DecodeKernel((uint8_t const*)source, unpadded, destination);
+    uint8_t* cursor = destination + index / 4 * 3;
+
+    for (; index < length; index += 4) {
+        int const a = MLBase64Values[(uint8_t)source[index]];
+        int const b = MLBase64Values[(uint8_t)source[index + 1]];
+        bool const isLast = index + 4 == length;
+        int const c = isLast && padding == 2 ? 0 : MLBase64Values[(uint8_t)source[index + 2]];
+        int const d = isLast && padding >= 1 ? 0 : MLBase64Values[(uint8_t)source[index + 3]];
+        if ((a | b | c | d) < 0) return -1;
+
+        uint32_t const triple = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+        *cursor++ = triple >> 16;
+        if (!isLast || padding < 2) *cursor++ = triple >> 8 & 0xFF;
+        if (!isLast || padding < 1) *cursor++ = triple & 0xFF;
+    }
+
+    return cursor - destination;
+}
+
+static MLInteger MLHexEncode(uint8_t const* source, MLInteger count, char* destination) {
+    static char const digits[] = "0123456789abcdef";
+
+    MLInteger index = MLHexEncodeKernel(source, count, (uint8_t*)destination);
+    for (; index < count; index += 1) {
+        destination[index * 2] = digits[source[index] >> 4];
+        destination[index * 2 + 1] = digits[source[index] & 0x0F];
+    }
+
+    return count * 2;
+}
+
+static inline int MLHexValue(char character) {
+    if (character >= '0' && character <= '9') return character - '0';
+    if (character >= 'a' && character <= 'f') return character - 'a' + 10;
+    if (character >= 'A' && character <= 'F') return character - 'A' + 10;
+    return -1;
+}
+
+// Returns the count of decoded bytes, or -1 if characters aren't hex digits.
+static MLInteger MLHexDecode(char const* source, MLInteger length, uint8_t* destination) {
+    if (length % 2 != 0) return -1;
+
+    MLInteger index = MLHexDecodeKernel((uint8_t const*)source, length, destination);
+    for (; index < length; index += 2) {
+        int const upper = MLHexValue(source[index]);
+        int const lower = MLHexValue(source[index + 1]);
+        if ((upper | lower) < 0) return -1;
+        destination[index / 2] = (uint8_t)(upper << 4 | lower);
+    }
+
+    return length / 2;
+}
+
+// ------------------------------------------------------- Trie Functions ------
+
+static inline struct MLTrieNode* MLTrieNodeMake(MLNatural count) {
+    struct MLTrieNode* node = calloc(1, sizeof(struct MLTrieNode) + 2 * count * sizeof(MLVariable));
+    node->retainCount = 1;
+    node->bitmap = 0;
+    node->count = count;
+    return node;
+}
+
+static inline void MLTrieNodeRetainSlots(MLVariable* slots, MLNatural count) {
+    for (MLNatural index = 0; index < count; index += 1) {
+        MLVariable const key = slots[index * 2];
+        MLVariable const value = slots[index * 2 + 1];
+        if (key == MLZero) {
+            __atomic_add_fetch(&((struct MLTrieNode*)value)->retainCount, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        MLSend(key, "retain");
+        MLSend(value, "retain");
+    }
+}
+
+// Nodes are shared between snapshots used by different threads, so their
+// counts change atomically like the retain counts of objects:
+static void MLTrieNodeRelease(struct MLTrieNode* node) {
+    if (__atomic_sub_fetch(&node->retainCount, 1, __ATOMIC_RELEASE) > 0) return;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    for (MLNatural index = 0; index < node->count; index += 1) {
+        MLVariable const key = node->slots[index * 2];
+        MLVariable const value = node->slots[index * 2 + 1];
+        if (key == MLZero) {
+            MLTrieNodeRelease(value);
+            continue;
+        }
+        MLSend(key, "release");
+        MLSend(value, "release");
+    }
+
+    free(node);
+}
+
+// Returns a node with room for `count` slots holding the slots of `node`, with
+// a gap of `gap` slots opening at `position`. If the node is editable its slots
+// are moved over and the node is left as an empty shell, otherwise they are
+// retained, so the caller can always release `node` once it replaced it.
+static struct MLTrieNode* MLTrieNodeResize(struct MLTrieNode* node, bool editable, MLNatural count, MLNatural position, MLNatural gap) {
+    struct MLTrieNode* const result = MLTrieNodeMake(count);
+    MLNatural const tail = MLMin(node->count - position, count - position - gap);
+
+    result->bitmap = node->bitmap;
+    memcpy(result->slots, node->slots, position * 2 * sizeof(MLVariable));
+    memcpy(result->slots + (position + gap) * 2, node->slots + (node->count - tail) * 2, tail * 2 * sizeof(MLVariable));
+
+    if (editable) {
+        node->count = 0;
+        return result;
+    }
+
+    MLTrieNodeRetainSlots(result->slots, position);
+    MLTrieNodeRetainSlots(result->slots + (position + gap) * 2, tail);
+    return result;
+}
+
+static inline struct MLTrieNode* MLTrieNodeCopy(struct MLTrieNode* node, bool editable) {
+    if (editable) return node;
+    return MLTrieNodeResize(node, false, node->count, node->count, 0);
+}
+
+static inline bool MLTrieKeysEqual(MLVariable key1, MLVariable key2) {
+    return key1 == key2 || MLSend(key1, "equals*", key2) == MLYes;
+}
+
+static inline MLNatural MLTrieHash(MLVariable key) {
+    return MLNaturalFrom(MLSend(key, "hash"));
+}
+
+static inline MLNatural MLTrieBit(MLNatural hash, MLNatural shift) {
+    return 1ul << ((hash >> shift) & MLTrieLevelMask);
+}
+
+static inline MLNatural MLTriePosition(struct MLTrieNode* node, MLNatural bit) {
+    return __builtin_popcountl(node->bitmap & (bit - 1));
+}
+
+static struct MLTrieNode* MLTrieNodeMakePair(MLNatural shift, MLNatural hash1, MLVariable key1, MLVariable value1, MLNatural hash2, MLVariable key2, MLVariable value2) {
+    if (shift >= MLTrieHashBits) {
+        struct MLTrieNode* node = MLTrieNodeMake(2);
+        node->slots[0] = MLSend(key1, "retain");
+        node->slots[1] = MLSend(value1, "retain");
+        node->slots[2] = MLSend(key2, "retain");
+        node->slots[3] = MLSend(value2, "retain");
+        return node;
+    }
+
+    MLNatural const bit1 = MLTrieBit(hash1, shift);
+    MLNatural const bit2 = MLTrieBit(hash2, shift);
+
+    if (bit1 == bit2) {
+        struct MLTrieNode* node = MLTrieNodeMake(1);
+        node->bitmap = bit1;
+        node->slots[0] = MLZero;
+        node->slots[1] = MLTrieNodeMakePair(shift + MLTrieBitsPerLevel, hash1, key1, value1, hash2, key2, value2);
+        return node;
+    }
+
+    struct MLTrieNode* node = MLTrieNodeMake(2);
+    MLNatural const first = bit1 < bit2 ? 0 : 1;
+    node->bitmap = bit1 | bit2;
+    node->slots[first * 2] = MLSend(key1, "retain");
+    node->slots[first * 2 + 1] = MLSend(value1, "retain");
+    node->slots[(1 - first) * 2] = MLSend(key2, "retain");
+    node->slots[(1 - first) * 2 + 1] = MLSend(value2, "retain");
+    return node;
+}
+
+static MLVariable MLTrieGet(struct MLTrieNode* node, MLNatural shift, MLNatural hash, MLVariable key) {
+    while (shift < MLTrieHashBits) {
+        MLNatural const bit = MLTrieBit(hash, shift);
+        if ((node->bitmap & bit) == 0) return MLNull;
+
+        MLNatural const position = MLTriePosition(node, bit);
+        MLVariable const keyAtPosition = node->slots[position * 2];
+        MLVariable const valueAtPosition = node->slots[position * 2 + 1];
+
+        if (keyAtPosition != MLZero) {
+            return MLTrieKeysEqual(keyAtPosition, key) ? valueAtPosition : MLNull;
+        }
+
+        node = valueAtPosition;
+        shift += MLTrieBitsPerLevel;
+    }
+
+    for (MLNatural index = 0; index < node->count; index += 1) {
+        if (MLTrieKeysEqual(node->slots[index * 2], key)) return node->slots[index * 2 + 1];
+    }
+
     return MLNull;
 }
 
-static MLVariable MLDataAtCount(struct MLData* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable options, ...) {
-    // TODO: implement.
-    return MLNull;
-}
+// Path-copying insert. Returns the node that replaces `node` in its parent,
+// which is `node` itself if nothing changed or if it was edited in place.
+// Editing in place is only allowed if the whole path is exclusively owned.
+static struct MLTrieNode* MLTrieSet(struct MLTrieNode* node, bool editable, MLNatural shift, MLNatural hash, MLVariable key, MLVariable value, bool* added) {
+    editable = editable && __atomic_load_n(&node->retainCount, __ATOMIC_ACQUIRE) == 1;
+
+    if (shift >= MLTrieHashBits) {
+        for (MLNatural index = 0; index < node->count; index += 1) {
+            if (!MLTrieKeysEqual(node->slots[index * 2], key)) continue;
+            if (node->slots[index * 2 + 1] == value) return node;
+
+            struct MLTrieNode* const result = MLTrieNodeCopy(node, editable);
+            MLSend(value, "retain");
+            MLSend(result->slots[index * 2 + 1], "release");
+            result->slots[index * 2 + 1] = value;
+            return result;
+        }
+
+        // Resizing an editable node empties it, so hold on to its count:
+        MLNatural const count = node->count;
+        struct MLTrieNode* const result = MLTrieNodeResize(node, editable, count + 1, count, 1);
+        result->slots[count * 2] = MLSend(key, "retain");
+        result->slots[count * 2 + 1] = MLSend(value, "retain");
+        *added = true;
+        return result;
+    }
+
+    MLNatural const bit = MLTrieBit(hash, shift);
+    MLNatural const position = MLTriePosition(node, bit);
+
+    if ((node->bitmap & bit) == 0) {
+        struct MLTrieNode* const result = MLTrieNodeResize(node, editable, node->count + 1, position, 1);
+        result->bitmap |= bit;
+        result->slots[position * 2] = MLSend(key, "retain");
+        result->slots[position * 2 + 1] = MLSend(value, "retain");
+        *added = true;
+        return result;
+    }
+
+    MLVariable const keyAtPosition = node->slots[position * 2];
+    MLVariable const valueAtPosition = node->slots[position * 2 + 1];
+
+    if (keyAtPosition == MLZero) {
+        struct MLTrieNode* const child = MLTrieSet(valueAtPosition, editable, shift + MLTrieBitsPerLevel, hash, key, value, added);
+        if (child == valueAtPosition) return node;
+
+        struct MLTrieNode* const result = MLTrieNodeCopy(node, editable);
+        MLTrieNodeRelease(result->slots[position * 2 + 1]);
+        result->slots[position * 2 + 1] = child;
+        return result;
+    }
+
+    if (MLTrieKeysEqual(keyAtPosition, key)) {
+        if (valueAtPosition == value) return node;
+
+        struct MLTrieNode* const result = MLTrieNodeCopy(node, editable);
+        MLSend(value, "retain");
+        MLSend(result->slots[position * 2 + 1], "release");
+        result->slots[position * 2 + 1] = value;
+        return result;
+    }
+
+    MLNatural const hashAtPosition = MLTrieHash(keyAtPosition);
+    struct MLTrieNode* const child = MLTrieNodeMakePair(shift + MLTrieBitsPerLevel, hashAtPosition, keyAtPosition, valueAtPosition, hash, key, value);
+    struct MLTrieNode* const result = MLTrieNodeCopy(node, editable);
+
+    MLSend(result->slots[position * 2], "release");
+    MLSend(result->slots[position * 2 + 1], "release");
+    result->slots[position * 2] = MLZero;
+    result->slots[position * 2 + 1] = child;
+    *added = true;
+    return result;
+}
+
+// Path-copying removal, same contract as MLTrieSet(). Returns MLZero if the
+// node became empty, nodes left with a single key/value pair get inlined into
+// their parent.
+static struct MLTrieNode* MLTrieRemove(struct MLTrieNode* node, bool editable, MLNatural shift, MLNatural hash, MLVariable key, bool* removed) {
+    editable = editable && __atomic_load_n(&node->retainCount, __ATOMIC_ACQUIRE) == 1;
+
+    MLNatural position = 0;
+    MLNatural bit = 0;
+
+    if (shift >= MLTrieHashBits) {
+        while (position < node->count && !MLTrieKeysEqual(node->slots[position * 2], key)) position += 1;
+        if (position >= node->count) return node;
+    }
+    else {
+        bit = MLTrieBit(hash, shift);
+        if ((node->bitmap & bit) == 0) return node;
+
+        position = MLTriePosition(node, bit);
+        MLVariable const keyAtPosition = node->slots[position * 2];
+        MLVariable const valueAtPosition = node->slots[position * 2 + 1];
+
+        if (keyAtPosition == MLZero) {
+            struct MLTrieNode* const child = MLTrieRemove(valueAtPosition, editable, shift + MLTrieBitsPerLevel, hash, key, removed);
+            if (child == valueAtPosition) return node;
+
+            if (child != MLZero) {
+                struct MLTrieNode* const result = MLTrieNodeCopy(node, editable);
+                bool const canInline = child->count == 1 && child->slots[0] != MLZero;
+                MLTrieNodeRelease(result->slots[position * 2 + 1]);
+
+                if (canInline) {
+                    result->slots[position * 2] = MLSend(child->slots[0], "retain");
+                    result->slots[position * 2 + 1] = MLSend(child->slots[1], "retain");
+                    MLTrieNodeRelease(child);
+                }
+                else {
+                    result->slots[position * 2 + 1] = child;
+                }
+
+                return result;
+            }
+        }
+        else if (!MLTrieKeysEqual(keyAtPosition, key)) {
+            return node;
+        }
+        else {
+            *removed = true;
+        }
+    }
+
+    if (node->count == 1) {
+        *removed = true;
+        return MLZero;
+    }
+
+    // Release the removed slot (only if the node keeps owning it) and close the gap:
+    MLVariable const keyToRemove = node->slots[position * 2];
+    MLVariable const valueToRemove = node->slots[position * 2 + 1];
+    struct MLTrieNode* const result = MLTrieNodeResize(node, editable, node->count - 1, position, 0);
+    result->bitmap &= ~bit;
+
+    if (editable && keyToRemove == MLZero) MLTrieNodeRelease(valueToRemove);
+    if (editable && keyToRemove != MLZero) MLSend(keyToRemove, "release");
+    if (editable && keyToRemove != MLZero) MLSend(valueToRemove, "release");
+
+    *removed = true;
+    return result;
+}
+
+static bool MLTrieContainsAll(struct MLTrieNode* node, MLNatural shift, struct MLPersistentDictionary* dictionary) {
+    for (MLNatural index = 0; index < node->count; index += 1) {
+        MLVariable const key = node->slots[index * 2];
+        MLVariable const value = node->slots[index * 2 + 1];
+
+        if (key == MLZero) {
+            if (!MLTrieContainsAll(value, shift + MLTrieBitsPerLevel, dictionary)) return false;
+            continue;
+        }
+
+        MLVariable const other = MLTrieGet(dictionary->root, 0, MLTrieHash(key), key);
+        if (other == MLNull || MLSend(value, "equals*", other) == MLNo) return false;
+    }
+
+    return true;
+}
+
+// Appends the entries as "key: value", separated by commas.
+static void MLTrieAppendEntries(struct MLTrieNode* node, struct MLStringBuilder* builder, bool* isFirst) {
+    for (MLNatural index = 0; index < node->count; index += 1) {
+        MLVariable const key = node->slots[index * 2];
+        MLVariable const value = node->slots[index * 2 + 1];
+
+        if (key == MLZero) {
+            MLTrieAppendEntries(value, builder, isFirst);
+            continue;
+        }
+
+        if (!*isFirst) MLStringBuilderAppendCharacters(builder, 2, ", ");
+        *isFirst = false;
+
+        MLSend(builder, "append*", key);
+        MLStringBuilderAppendCharacters(builder, 2, ": ");
+        MLSend(builder, "append*", value);
+    }
+}
+
+// ----------------------------------------------------- Number Functions ------
+
+static inline struct MLDiyFp MLDiyFpMultiply(struct MLDiyFp x, struct MLDiyFp y) {
+    unsigned __int128 const product = (unsigned __int128)x.f * y.f;
+    uint64_t const high = (uint64_t)(product >> 64);
+    uint64_t const low = (uint64_t)product;
+    return (struct MLDiyFp){high + (low >> 63), x.e + y.e + 64};
+}
+
+static inline struct MLDiyFp MLDiyFpNormalize(struct MLDiyFp x) {
+    int const shift = __builtin_clzll(x.f);
+    return (struct MLDiyFp){x.f << shift, x.e - shift};
+}
+
+static inline void MLGrisuRound(char* digits, int count, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance) {
+    while (rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+        digits[count - 1] -= 1;
+        rest += tenKappa;
+    }
+}
+
+static int MLGrisuGenerateDigits(struct MLDiyFp w, struct MLDiyFp upper, uint64_t delta, char* digits, int* exponent) {
+    static uint64_t const powersOfTen[20] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+        10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+        1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+    };
+
+    struct MLDiyFp const one = {1ull << -upper.e, upper.e};
+    uint64_t const distance = upper.f - w.f;
+    uint32_t integral = (uint32_t)(upper.f >> -one.e);
+    uint64_t fractional = upper.f & (one.f - 1);
+    int kappa = 1;
+    int count = 0;
+
+    while (kappa < 10 && integral >= powersOfTen[kappa]) kappa += 1;
+
+    // Digits of the integral part, stop as soon as the rest is within delta:
+    while (kappa > 0) {
+        uint32_t const digit = integral / powersOfTen[kappa - 1];
+        integral %= powersOfTen[kappa - 1];
+        if (digit != 0 || count != 0) digits[count++] = '0' + digit;
+        kappa -= 1;
+
+        uint64_t const rest = ((uint64_t)integral << -one.e) + fractional;
+        if (rest <= delta) {
+            *exponent += kappa;
+            MLGrisuRound(digits, count, delta, rest, powersOfTen[kappa] << -one.e, distance);
+            return count;
+        }
+    }
+
+    // Digits of the fractional part:
+    while (true) {
+        fractional *= 10;
+        delta *= 10;
+        uint32_t const digit = (uint32_t)(fractional >> -one.e);
+        if (digit != 0 || count != 0) digits[count++] = '0' + digit;
+        fractional &= one.f - 1;
+        kappa -= 1;
+
+        if (fractional < delta) {
+            *exponent += kappa;
+            MLGrisuRound(digits, count, delta, fractional, one.f, -kappa < 20 ? distance * powersOfTen[-kappa] : 0);
+            return count;
+        }
+    }
+}
+
+// Writes the shortest digits (Grisu2, Loitsch 2010) of a positive, finite
+// number, which equals digits * 10^exponent. Returns the count of digits.
+static int MLGrisu(MLDecimal number, char* digits, int* exponent) {
+    uint64_t bits = 0;
+    memcpy(&bits, &number, sizeof(bits));
+
+    uint64_t const hidden = 1ull << 52;
+    uint64_t const significand = bits & (hidden - 1);
+    int const biasedExponent = (int)((bits >> 52) & 0x7FF);
+    struct MLDiyFp const v = biasedExponent != 0 ? (struct MLDiyFp){significand + hidden, biasedExponent - 1075} : (struct MLDiyFp){significand, -1074};
+
+    // Boundaries halfway to the neighbouring numbers, with a common exponent:
+    struct MLDiyFp const upper = MLDiyFpNormalize((struct MLDiyFp){(v.f << 1) + 1, v.e - 1});
+    struct MLDiyFp lower = v.f == hidden ? (struct MLDiyFp){(v.f << 2) - 1, v.e - 2} : (struct MLDiyFp){(v.f << 1) - 1, v.e - 1};
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    // Scale by a cached power of ten that brings the exponent into [-60, -32]:
+    double const estimate = (-61 - upper.e) * 0.30102999566398114 + 347;
+    int k = (int)estimate;
+    if (estimate - k > 0.0) k += 1;
+
+    unsigned const index = (unsigned)((k >> 3) + 1);
+    struct MLDiyFp const power = {MLNumberCachedPowersF[index], MLNumberCachedPowersE[index]};
+    *exponent = 348 - (int)index * 8;
+
+    struct MLDiyFp const w = MLDiyFpMultiply(MLDiyFpNormalize(v), power);
+    struct MLDiyFp upperScaled = MLDiyFpMultiply(upper, power);
+    struct MLDiyFp lowerScaled = MLDiyFpMultiply(lower, power);
+    upperScaled.f -= 1;
+    lowerScaled.f += 1;
+
+    return MLGrisuGenerateDigits(w, upperScaled, upperScaled.f - lowerScaled.f, digits, exponent);
+}
+
+// Writes a number in the shortest form that reads back as the same number,
+// the buffer must hold MLNumberFormatMaximumLength characters. Returns the
+// length.
+static MLInteger MLNumberFormat(MLDecimal number, char* buffer) {
+    char* cursor = buffer;
+
+    if (isnan(number)) {
+        memcpy(buffer, "nan", 3);
+        return 3;
+    }
+
+    if (number < 0) {
+        *cursor++ = '-';
+        number = -number;
+    }
+
+    if (isinf(number)) {
+        memcpy(cursor, "inf", 3);
+        return cursor + 3 - buffer;
+    }
+
+    // Integers that doubles represent exactly don't need Grisu:
+    if (number < (MLDecimal)MLNumberExactMantissaMax && number == (MLDecimal)(uint64_t)number) {
+        char digits[20];
+        int count = 0;
+        uint64_t integer = (uint64_t)number;
+
+        do {
+            digits[count++] = '0' + integer % 10;
+            integer /= 10;
+        } while (integer != 0);
+
+        while (count > 0) *cursor++ = digits[--count];
+        return cursor - buffer;
+    }
+
+    char digits[20];
+    int exponent = 0;
+    int const count = MLGrisu(number, digits, &exponent);
+    int const point = count + exponent;
+
+    // Like JavaScript: plain notation for 1e-6 <= number < 1e21, else exponential:
+    if (count <= point && point <= 21) {
+        memcpy(cursor, digits, count);
+        memset(cursor + count, '0', point - count);
+        cursor += point;
+    }
+    else if (0 < point && point <= 21) {
+        memcpy(cursor, digits, point);
+        cursor[point] = '.';
+        memcpy(cursor + point + 1, digits + point, count - point);
+        cursor += count + 1;
+    }
+    else if (-6 < point && point <= 0) {
+        memcpy(cursor, "0.", 2);
+        memset(cursor + 2, '0', -point);
+        memcpy(cursor + 2 - point, digits, count);
+        cursor += 2 - point + count;
+    }
+    else {
+        *cursor++ = digits[0];
+        if (count > 1) {
+            *cursor++ = '.';
+            memcpy(cursor, digits + 1, count - 1);
+            cursor += count - 1;
+        }
+        cursor += sprintf(cursor, "e%+d", point - 1);
+    }
+
+    return cursor - buffer;
+}
+
+// Parses a decimal number. Those with up to 19 significant digits and small
+// exponents are exact in double arithmetic (Clinger's fast path), all others
+// go through strtod(). Returns false if characters aren't a number.
+static bool MLNumberParse(MLInteger length, char const* characters, MLDecimal* number) {
+    static MLDecimal const powersOfTen[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    MLInteger index = 0;
+    bool const negative = length > 0 && characters[0] == '-';
+    if (length > 0 && (characters[0] == '-' || characters[0] == '+')) index += 1;
+
+    uint64_t mantissa = 0;
+    MLInteger digitsCount = 0;
+    MLInteger significantCount = 0;
+    MLInteger exponent = 0;
+
+    for (; index < length && characters[index] >= '0' && characters[index] <= '9'; index += 1) {
+        mantissa = mantissa * 10 + (characters[index] - '0');
+        digitsCount += 1;
+        if (mantissa != 0) significantCount += 1;
+        if (significantCount > MLNumberExactDigitsCount) break;
+    }
+
+    if (index < length && characters[index] == '.') {
+        for (index += 1; index < length && characters[index] >= '0' && characters[index] <= '9'; index += 1) {
+            mantissa = mantissa * 10 + (characters[index] - '0');
+            digitsCount += 1;
+            exponent -= 1;
+            if (mantissa != 0) significantCount += 1;
+            if (significantCount > MLNumberExactDigitsCount) break;
+        }
+    }
+
+    if (index < length && (characters[index] == 'e' || characters[index] == 'E') && digitsCount > 0) {
+        MLInteger const start = index;
+        bool const negativeExponent = index + 1 < length && characters[index + 1] == '-';
+        if (index + 1 < length && (characters[index + 1] == '-' || characters[index + 1] == '+')) index += 1;
+
+        MLInteger const digitsStart = index + 1;
+        MLInteger value = 0;
+        for (index += 1; index < length && characters[index] >= '0' && characters[index] <= '9'; index += 1) {
+            if (value < 100000) value = value * 10 + (characters[index] - '0');
+        }
+
+        // Without exponent digits, leave the rest to strtod():
+        if (index == digitsStart) index = start;
+        else exponent += negativeExponent ? -value : value;
+    }
+
+    bool const isPlain = index == length && digitsCount > 0;
+    if (isPlain && mantissa <= MLNumberExactMantissaMax && exponent >= -22 && exponent <= 22) {
+        MLDecimal value = (MLDecimal)mantissa;
+        value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+        *number = negative ? -value : value;
+        return true;
+    }
+
+    // strtod() needs the characters to end with '\0':
+    if (length == 0 || characters[0] == ' ' || (characters[0] >= '\t' && characters[0] <= '\r')) return false;
+
+    char* const copy = malloc(length + 1);
+    memcpy(copy, characters, length);
+    copy[length] = '\0';
+
+    char* end = MLZero;
+    *number = strtod(copy, &end);
+    bool const isNumber = end == copy + length;
+    free(copy);
+
+    return isNumber;
+}
+
+// ----------------------------------------------------- Vector Functions ------
+
+// Bulk operations on packed numbers, 4 lanes at a time. The vector types are
+// lowered to whatever the target has (two SSE2 registers on plain x86-64).
+// Sums keep 4 partial sums, so decimal results may differ from a sequential
+// sum in the last bits.
+
+#define MLVectorLoad(Vector, values) ({ Vector loaded; memcpy(&loaded, (values), sizeof(Vector)); loaded; })
+#define MLVectorStore(values, vector) ({ __typeof__(vector) stored = (vector); memcpy((values), &stored, sizeof(stored)); })
+
+#define MLVectorKernels(Name, Type, Vector) \
+    static Type MLVector##Name##Sum(MLInteger count, Type const* values) { \
+        Vector sums = {0}; \
+        MLInteger i = 0; \
+        for (; i + MLVectorLanesCount <= count; i += MLVectorLanesCount) sums += MLVectorLoad(Vector, values + i); \
+        Type sum = sums[0] + sums[1] + sums[2] + sums[3]; \
+        for (; i < count; i += 1) sum += values[i]; \
+        return sum; \
+    } \
+    \
+    static Type MLVector##Name##Dot(MLInteger count, Type const* values1, Type const* values2) { \
+        Vector sums = {0}; \
+        MLInteger i = 0; \
+        for (; i + MLVectorLanesCount <= count; i += MLVectorLanesCount) sums += MLVectorLoad(Vector, values1 + i) * MLVectorLoad(Vector, values2 + i); \
+        Type sum = sums[0] + sums[1] + sums[2] + sums[3]; \
+        for (; i < count; i += 1) sum += values1[i] * values2[i]; \
+        return sum; \
+    } \
+    \
+    /* Returns the minimum, or the maximum if `maximum` is set, of at least one value. */ \
+    static Type MLVector##Name##Extreme(MLInteger count, Type const* values, bool maximum) { \
+        Vector extremes = {values[0], values[0], values[0], values[0]}; \
+        MLInteger i = 0; \
+        for (; i + MLVectorLanesCount <= count; i += MLVectorLanesCount) { \
+            Vector const vector = MLVectorLoad(Vector, values + i); \
+            MLVectorMask const mask = maximum ? vector > extremes : vector < extremes; \
+            extremes = (Vector)(((MLVectorMask)vector & mask) | ((MLVectorMask)extremes & ~mask)); \
+        } \
+        Type extreme = extremes[0]; \
+        for (int lane = 1; lane < MLVectorLanesCount; lane += 1) extreme = (maximum ? extremes[lane] > extreme : extremes[lane] < extreme) ? extremes[lane] : extreme; \
+        for (; i < count; i += 1) extreme = (maximum ? values[i] > extreme : values[i] < extreme) ? values[i] : extreme; \
+        return extreme; \
+    } \
+    \
+    static void MLVector##Name##Scale(MLInteger count, Type* values, Type factor) { \
+        MLInteger i = 0; \
+        for (; i + MLVectorLanesCount <= count; i += MLVectorLanesCount) MLVectorStore(values + i, MLVectorLoad(Vector, values + i) * factor); \
+        for (; i < count; i += 1) values[i] *= factor; \
+    } \
+    \
+    static void MLVector##Name##Add(MLInteger count, Type* values1, Type const* values2) { \
+        MLInteger i = 0; \
+        for (; i + MLVectorLanesCount <= count; i += MLVectorLanesCount) MLVectorStore(values1 + i, MLVectorLoad(Vector, values1 + i) + MLVectorLoad(Vector, values2 + i)); \
+        for (; i < count; i += 1) values1[i] += values2[i]; \
+    }
+
+MLVectorKernels(Decimals, double, MLDecimalVector)
+MLVectorKernels(Integers, int64_t, MLIntegerVector)
+
+#undef MLVectorKernels
+
+// ------------------------------------------------------- Pool Functions ------
+
+static void MLPoolStart() {
+    long const cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    MLThreadPool.count = MLMax(cores, 1);
+    MLThreadPool.workers = calloc(MLThreadPool.count, sizeof(struct MLWorker));
+    pthread_mutex_init(&MLThreadPool.mutex, NULL);
+    pthread_cond_init(&MLThreadPool.wake, NULL);
+    pthread_cond_init(&MLThreadPool.finished, NULL);
+
+    for (MLInteger index = 0; index < MLThreadPool.count; index += 1) {
+        struct MLWorker* const worker = &MLThreadPool.workers[index];
+        worker->deque.tasks = calloc(MLPoolDequeCapacity, sizeof(struct MLTask*));
+        worker->seed = (unsigned)index * 2654435761u + 1;
+        pthread_create(&worker->thread, NULL, MLPoolWorkerMain, worker);
+        pthread_detach(worker->thread);
+    }
+}
+
+static struct MLTask* MLPoolTaskMake(struct MLJob* job, MLInteger start, MLInteger end) {
+    struct MLTask* const task = calloc(1, sizeof(struct MLTask));
+    task->job = job;
+    task->start = start;
+    task->end = end;
+    return task;
+}
+
+// Only the deque's own worker pushes, returns false if the deque is full.
+static bool MLDequePush(struct MLDeque* deque, struct MLTask* task) {
+    MLInteger const bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    MLInteger const top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    if (bottom - top >= MLPoolDequeCapacity) return false;
+
+    __atomic_store_n(&deque->tasks[bottom & (MLPoolDequeCapacity - 1)], task, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_SEQ_CST);
+    return true;
+}
+
+// Only the deque's own worker pops, racing thieves for the last task.
+static struct MLTask* MLDequePop(struct MLDeque* deque) {
+    MLInteger const bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_SEQ_CST);
+    MLInteger top = __atomic_load_n(&deque->top, __ATOMIC_SEQ_CST);
+
+    if (top > bottom) {
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return MLZero;
+    }
+
+    struct MLTask* task = __atomic_load_n(&deque->tasks[bottom & (MLPoolDequeCapacity - 1)], __ATOMIC_RELAXED);
+    if (top < bottom) return task;
+
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) task = MLZero;
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return task;
+}
+
+static struct MLTask* MLDequeSteal(struct MLDeque* deque) {
+    MLInteger top = __atomic_load_n(&deque->top, __ATOMIC_SEQ_CST);
+    MLInteger const bottom = __atomic_load_n(&deque->bottom, __ATOMIC_SEQ_CST);
+    if (top >= bottom) return MLZero;
+
+    struct MLTask* const task = __atomic_load_n(&deque->tasks[top & (MLPoolDequeCapacity - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) return MLZero;
+    return task;
+}
+
+static bool MLPoolHasWork() {
+    if (__atomic_load_n(&MLThreadPool.injected, __ATOMIC_SEQ_CST) != MLZero) return true;
+
+    for (MLInteger index = 0; index < MLThreadPool.count; index += 1) {
+        struct MLDeque* const deque = &MLThreadPool.workers[index].deque;
+        if (__atomic_load_n(&deque->top, __ATOMIC_SEQ_CST) < __atomic_load_n(&deque->bottom, __ATOMIC_SEQ_CST)) return true;
+    }
+
+    return false;
+}
+
+static void MLPoolWake() {
+    if (__atomic_load_n(&MLThreadPool.sleepers, __ATOMIC_SEQ_CST) == 0) return;
+
+    pthread_mutex_lock(&MLThreadPool.mutex);
+    pthread_cond_signal(&MLThreadPool.wake);
+    pthread_mutex_unlock(&MLThreadPool.mutex);
+}
+
+// Takes a task from the worker's own deque, then from the injected ones,
+// then tries to steal one, starting at a random other worker.
+static struct MLTask* MLPoolFindTask(struct MLWorker* worker) {
+    struct MLTask* task = MLDequePop(&worker->deque);
+    if (task != MLZero) return task;
+
+    if (__atomic_load_n(&MLThreadPool.injected, __ATOMIC_SEQ_CST) != MLZero) {
+        pthread_mutex_lock(&MLThreadPool.mutex);
+        task = MLThreadPool.injected;
+        if (task != MLZero) __atomic_store_n(&MLThreadPool.injected, task->next, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&MLThreadPool.mutex);
+        if (task != MLZero) return task;
+    }
+
+    worker->seed = worker->seed * 1103515245 + 12345;
+    MLInteger const first = (worker->seed >> 8) % MLThreadPool.count;
+
+    for (MLInteger i = 0; i < MLThreadPool.count; i += 1) {
+        struct MLWorker* const victim = &MLThreadPool.workers[(first + i) % MLThreadPool.count];
+        if (victim == worker) continue;
+
+        task = MLDequeSteal(&victim->deque);
+        if (task != MLZero) return task;
+    }
+
+    return MLZero;
+}
+
+// Runs one chunk of a job inside its own collect block. Kept out of line so
+// the collect block doesn't live across the caller's sigsetjmp.
+__attribute__((noinline)) static void MLPoolCollectChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    MLCollect {
+        job->function(job, start, end);
+    }
+}
+
+// Runs one chunk of a job, an exception ends up in the job for the submitter
+// to raise.
+static void MLPoolRunChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    if (__atomic_load_n(&job->exception, __ATOMIC_ACQUIRE) == MLZero) {
+        MLPerform {
+            MLPoolCollectChunk(job, start, end);
+        }
+        MLHandle {
+            MLVariable expected = MLZero;
+            MLSend(exception, "retain");
+            if (!__atomic_compare_exchange_n(&job->exception, &expected, exception, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) MLSend(exception, "release");
+        }
+    }
+
+    if (__atomic_sub_fetch(&job->remaining, end - start, __ATOMIC_ACQ_REL) == 0) {
+        pthread_mutex_lock(&MLThreadPool.mutex);
+        pthread_cond_broadcast(&MLThreadPool.finished);
+        pthread_mutex_unlock(&MLThreadPool.mutex);
+    }
+}
+
+// Splits the upper halves of the task off for other workers to steal until
+// a single chunk is left, then runs it.
+static void MLPoolRunTask(struct MLWorker* worker, struct MLTask* task) {
+    struct MLJob* const job = task->job;
+    MLInteger const chunkCount = job->chunkCount;
+    MLInteger const start = task->start;
+    MLInteger end = task->end;
+    free(task);
+
+    while (end - start > chunkCount) {
+        MLInteger const chunksCount = (end - start + chunkCount - 1) / chunkCount;
+        MLInteger const middle = start + chunksCount / 2 * chunkCount;
+        struct MLTask* const half = MLPoolTaskMake(job, middle, end);
+
+        if (!MLDequePush(&worker->deque, half)) {
+            free(half);
+            break;
+        }
+
+        MLPoolWake();
+        end = middle;
+    }
+
+    // The job may be gone as soon as its last chunk is done:
+    for (MLInteger chunk = start; chunk < end; chunk += chunkCount) {
+        MLPoolRunChunk(job, chunk, MLMin(chunk + chunkCount, end));
+    }
+}
+
+static void* MLPoolWorkerMain(void* argument) {
+    struct MLWorker* const worker = argument;
+    MLPoolThreadWorker = worker;
+
+    for (;;) {
+        struct MLTask* const task = MLPoolFindTask(worker);
+
+        if (task != MLZero) {
+            MLPoolRunTask(worker, task);
+            continue;
+        }
+
+        // Announce sleeping before the last look for work, so that a task
+        // pushed in between wakes this worker up again:
+        pthread_mutex_lock(&MLThreadPool.mutex);
+        __atomic_add_fetch(&MLThreadPool.sleepers, 1, __ATOMIC_SEQ_CST);
+        if (!MLPoolHasWork()) pthread_cond_wait(&MLThreadPool.wake, &MLThreadPool.mutex);
+        __atomic_sub_fetch(&MLThreadPool.sleepers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&MLThreadPool.mutex);
+    }
+
+    return MLZero;
+}
+
+// Hands the task to the pool without waiting for it. Workers push it onto
+// their own deque, where it's likely to be run by the same worker, everybody
+// else injects it.
+static void MLPoolSubmit(struct MLTask* task) {
+    pthread_once(&MLThreadPoolOnce, MLPoolStart);
+
+    struct MLWorker* const worker = MLPoolThreadWorker;
+    if (worker != MLZero && MLDequePush(&worker->deque, task)) {
+        MLPoolWake();
+        return;
+    }
+
+    pthread_mutex_lock(&MLThreadPool.mutex);
+    task->next = MLThreadPool.injected;
+    __atomic_store_n(&MLThreadPool.injected, task, __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&MLThreadPool.wake);
+    pthread_mutex_unlock(&MLThreadPool.mutex);
+}
+
+// Waits for the job to finish. Workers keep running other tasks meanwhile,
+// possibly the job's own, since blocking them could starve the pool.
+static void MLPoolWait(struct MLJob* job) {
+    struct MLWorker* const worker = MLPoolThreadWorker;
+
+    if (worker != MLZero) {
+        while (__atomic_load_n(&job->remaining, __ATOMIC_ACQUIRE) > 0) {
+            struct MLTask* const task = MLPoolFindTask(worker);
+            if (task != MLZero) MLPoolRunTask(worker, task);
+            else sched_yield();
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&MLThreadPool.mutex);
+
+    while (__atomic_load_n(&job->remaining, __ATOMIC_ACQUIRE) > 0) {
+        pthread_cond_wait(&MLThreadPool.finished, &MLThreadPool.mutex);
+    }
+
+    pthread_mutex_unlock(&MLThreadPool.mutex);
+}
+
+// Runs the job over all objects of its array and waits for it to finish.
+// Small arrays, and jobs started by blocks already running on the pool, are
+// run right here in a single chunk instead.
+static void MLPoolRun(struct MLJob* job) {
+    MLInteger const count = job->array->count;
+    job->remaining = count;
+
+    if (count < 2 * MLPoolChunkMinimumCount || MLPoolThreadWorker != MLZero) {
+        job->chunkCount = MLMax(count, 1);
+        if (count > 0) MLPoolRunChunk(job, 0, count);
+        return;
+    }
+
+    pthread_once(&MLThreadPoolOnce, MLPoolStart);
+    job->chunkCount = MLMax(count / (MLThreadPool.count * MLPoolChunksPerWorker), MLPoolChunkMinimumCount);
+
+    MLPoolSubmit(MLPoolTaskMake(job, 0, count));
+    MLPoolWait(job);
+}
+
+// ------------------------------------------------------- Sort Functions ------
+
+// Stable, adaptive merge sort in the style of timsort: natural runs (strictly
+// descending ones get reversed) are extended to a minimum length by binary
+// insertion, then merged off a stack that keeps run lengths balanced. Merges
+// skip whatever is already in place on either end.
+//
+// `mergeRange` merges output positions [start, end) of two sorted ranges, it
+// finds where its inputs begin by binary search (co-ranking), which is what
+// lets one large merge be split across workers.
+
+static inline bool MLSortNumberIsBefore(struct MLSort* sort, struct MLSortEntry const* entry1, struct MLSortEntry const* entry2) {
+    return entry1->number < entry2->number;
+}
+
+static inline bool MLSortStringIsBefore(struct MLSort* sort, struct MLSortEntry const* entry1, struct MLSortEntry const* entry2) {
+    if (entry1->characters == entry2->characters) return entry1->length < entry2->length;
+    int const result = memcmp(entry1->characters, entry2->characters, MLMin(entry1->length, entry2->length));
+    return result < 0 || (result == 0 && entry1->length < entry2->length);
+}
+
+// Anything but a negative number means not before:
+static inline bool MLSortResultIsBefore(MLVariable result) {
+    return result != MLZero && object(result).meta == &MLNumberMeta && MLDecimalFrom(result) < 0;
+}
+
+static inline bool MLSortObjectIsBefore(struct MLSort* sort, struct MLSortEntry const* entry1, struct MLSortEntry const* entry2) {
+    return MLSortResultIsBefore(MLSend(entry1->object, "compare*", entry2->object));
+}
+
+static inline bool MLSortBlockIsBefore(struct MLSort* sort, struct MLSortEntry const* entry1, struct MLSortEntry const* entry2) {
+    return MLSortResultIsBefore(sort->code(sort->block, MLZero, MLZero, entry1->object, entry2->object, MLZero));
+}
+
+static MLInteger MLSortMinimumRun(MLInteger count) {
+    MLInteger remainder = 0;
+
+    while (count >= MLSortMinimumRunCount) {
+        remainder |= count & 1;
+        count >>= 1;
+    }
+
+    return count + remainder;
+}
+
+static void MLSortReverse(struct MLSortEntry* entries, MLInteger count) {
+    for (MLInteger i = 0, j = count - 1; i < j; i += 1, j -= 1) {
+        struct MLSortEntry const entry = entries[i];
+        entries[i] = entries[j];
+        entries[j] = entry;
+    }
+}
+
+#define MLSortKernels(Name, IsBefore) \
+    /* Sorts `entries` given the first `sortedCount` already are. */ \
+    static void MLSortInsert##Name(struct MLSort* sort, struct MLSortEntry* entries, MLInteger sortedCount, MLInteger count) { \
+        for (MLInteger i = sortedCount; i < count; i += 1) { \
+            struct MLSortEntry const entry = entries[i]; \
+            MLInteger low = 0; \
+            MLInteger high = i; \
+            while (low < high) { \
+                MLInteger const middle = low + (high - low) / 2; \
+                if (IsBefore(sort, &entry, &entries[middle])) high = middle; \
+                else low = middle + 1; \
+            } \
+            memmove(entries + low + 1, entries + low, (i - low) * sizeof(struct MLSortEntry)); \
+            entries[low] = entry; \
+        } \
+    } \
+    \
+    /* Merges two adjacent sorted ranges in place, through `scratch`. */ \
+    static void MLSortMergeRuns##Name(struct MLSort* sort, struct MLSortEntry* left, MLInteger leftCount, MLInteger rightCount, struct MLSortEntry* scratch) { \
+        struct MLSortEntry* const right = left + leftCount; \
+        if (!IsBefore(sort, &right[0], &left[leftCount - 1])) return; \
+        \
+        /* Left entries up to the first right one and right entries after the last left one stay: */ \
+        MLInteger low = 0; \
+        MLInteger high = leftCount; \
+        while (low < high) { \
+            MLInteger const middle = low + (high - low) / 2; \
+            if (IsBefore(sort, &right[0], &left[middle])) high = middle; \
+            else low = middle + 1; \
+        } \
+        left += low; \
+        leftCount -= low; \
+        \
+        low = 0; \
+        high = rightCount; \
+        while (low < high) { \
+            MLInteger const middle = low + (high - low) / 2; \
+            if (IsBefore(sort, &right[middle], &left[leftCount - 1])) low = middle + 1; \
+            else high = middle; \
+        } \
+        rightCount = low; \
+        \
+        memcpy(scratch, left, leftCount * sizeof(struct MLSortEntry)); \
+        MLInteger i = 0; \
+        MLInteger j = 0; \
+        MLInteger k = 0; \
+        while (i < leftCount && j < rightCount) { \
+            if (IsBefore(sort, &right[j], &scratch[i])) left[k++] = right[j++]; \
+            else left[k++] = scratch[i++]; \
+        } \
+        memcpy(left + k, scratch + i, (leftCount - i) * sizeof(struct MLSortEntry)); \
+    } \
+    \
+    static void MLSortRange##Name(struct MLSort* sort, struct MLSortEntry* entries, struct MLSortEntry* scratch, MLInteger count) { \
+        MLInteger const minimumRun = MLSortMinimumRun(count); \
+        MLInteger runStarts[MLSortRunsCapacity]; \
+        MLInteger runCounts[MLSortRunsCapacity]; \
+        MLInteger runsCount = 0; \
+        \
+        for (MLInteger start = 0; start < count; ) { \
+            MLInteger end = start + 1; \
+            if (end < count && IsBefore(sort, &entries[end], &entries[start])) { \
+                while (end + 1 < count && IsBefore(sort, &entries[end + 1], &entries[end])) end += 1; \
+                end += 1; \
+                MLSortReverse(entries + start, end - start); \
+            } \
+            else { \
+                while (end < count && !IsBefore(sort, &entries[end], &entries[end - 1])) end += 1; \
+            } \
+            \
+            MLInteger const forcedEnd = MLMin(start + minimumRun, count); \
+            if (end < forcedEnd) { \
+                MLSortInsert##Name(sort, entries + start, end - start, forcedEnd - start); \
+                end = forcedEnd; \
+            } \
+            \
+            runStarts[runsCount] = start; \
+            runCounts[runsCount] = end - start; \
+            runsCount += 1; \
+            start = end; \
+            \
+            /* Keep each run longer than the two above it, merge everything once done: */ \
+            while (runsCount > 1) { \
+                MLInteger k = runsCount - 2; \
+                if (start == count) { \
+                    if (k > 0 && runCounts[k - 1] < runCounts[k + 1]) k -= 1; \
+                } \
+                else if ((k > 0 && runCounts[k - 1] <= runCounts[k] + runCounts[k + 1]) || (k > 1 && runCounts[k - 2] <= runCounts[k - 1] + runCounts[k])) { \
+                    if (runCounts[k - 1] < runCounts[k + 1]) k -= 1; \
+                } \
+                else if (runCounts[k] > runCounts[k + 1]) break; \
+                \
+                MLSortMergeRuns##Name(sort, entries + runStarts[k], runCounts[k], runCounts[k + 1], scratch); \
+                runCounts[k] += runCounts[k + 1]; \
+                for (MLInteger i = k + 1; i < runsCount - 1; i += 1) { \
+                    runStarts[i] = runStarts[i + 1]; \
+                    runCounts[i] = runCounts[i + 1]; \
+                } \
+                runsCount -= 1; \
+            } \
+        } \
+    } \
+    \
+    static void MLSortMergeRange##Name(struct MLSort* sort, struct MLSortEntry const* left, MLInteger leftCount, struct MLSortEntry const* right, MLInteger rightCount, MLInteger start, MLInteger end, struct MLSortEntry* target) { \
+        /* How many of the first `start` merged entries come from the left: */ \
+        MLInteger low = MLMax(0, start - rightCount); \
+        MLInteger high = MLMin(start, leftCount); \
+        while (low < high) { \
+            MLInteger const middle = low + (high - low) / 2; \
+            if (IsBefore(sort, &right[start - middle - 1], &left[middle])) high = middle; \
+            else low = middle + 1; \
+        } \
+        \
+        MLInteger i = low; \
+        MLInteger j = start - low; \
+        for (MLInteger k = start; k < end; k += 1) { \
+            if (j < rightCount && (i >= leftCount || IsBefore(sort, &right[j], &left[i]))) target[k - start] = right[j++]; \
+            else target[k - start] = left[i++]; \
+        } \
+    }
+
+MLSortKernels(Numbers, MLSortNumberIsBefore)
+MLSortKernels(Strings, MLSortStringIsBefore)
+MLSortKernels(Objects, MLSortObjectIsBefore)
+MLSortKernels(Block, MLSortBlockIsBefore)
+
+#undef MLSortKernels
+
+// ------------------------------------------------------- Hash Functions ------
+
+// Hashes are handed out as numbers, which hold only 53 bits exactly. The low
+// bits are kept, those pick the bucket in a hash table.
+static inline MLVariable MLHashNumber(MLNatural hash) {
+    return MLNumber((MLDecimal)(hash & (MLNumberExactMantissaMax - 1)));
+}
+
+// ------------------------------------------------------- Object Methods ------
+
+static MLVariable MLObjectAllocate(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return calloc(1, self->meta->size);
+}
+
+static MLVariable MLObjectCreate(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLVariable mutable = MLOption("mutable", MLNo);
+    MLVariable copy = MLOption("copy", MLNull);
+
+    if (copy != MLNull) {
+        MLSend(self, "fail*", MLString("InvalidOptionException | Can't create a copy of X"));
+        return MLNull;
+    }
+
+    struct MLMeta* meta = self->meta;
+    struct MLObject* object = self;
+
+    if (object->retainCountAndFlags >= MLRetainCountOne) {
+        object = MLSend(self, "allocate", MLOptions(MLString("mutable"), mutable));
+        object->meta = meta;
+    }
+
+    object->retainCountAndFlags = MLRetainCountOne;
+    if (mutable == MLYes) object->retainCountAndFlags |= MLMutableFlag;
+
+    return MLSend(object, "collect");
+}
+
+static MLVariable MLObjectDestroy(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    free(self);
+    return MLNull;
+}
+
+static MLVariable MLObjectRetain(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (__atomic_load_n(&self->retainCountAndFlags, __ATOMIC_RELAXED) < MLRetainCountMax) __atomic_fetch_add(&self->retainCountAndFlags, MLRetainCountOne, __ATOMIC_RELAXED);
+    return self;
+}
+
+static MLVariable MLObjectRelease(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLNatural const retainCountAndFlags = __atomic_load_n(&self->retainCountAndFlags, __ATOMIC_RELAXED);
+
+    if (retainCountAndFlags >= MLRetainCountMax) {
+        return self;
+    }
+
+    else if (retainCountAndFlags < MLRetainCountOne) {
+        fprintf(stderr, "[WARNING] Released an object with retain count 0, retain/release calls seem to be unbalanced, aborting ...\n");
+        return MLNull;
+    }
+
+    // Only the thread dropping the last reference destroys the object:
+    else if (__atomic_fetch_sub(&self->retainCountAndFlags, MLRetainCountOne, __ATOMIC_RELEASE) >= 2 * MLRetainCountOne) {
+        return self;
+    }
+
+    else {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return MLSend(self, "destroy");
+    }
+}
+
+static MLVariable MLObjectCollect(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLCollectBlockAdd(self);
+}
+
+static MLVariable MLObjectEternize(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    __atomic_store_n(&self->retainCountAndFlags, MLRetainCountMax, __ATOMIC_RELAXED);
+    return self;
+}
+
+static MLVariable MLObjectIsKindOf(struct MLObject* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    MLVariable proto = self;
+    do {
+        if (proto == object) return MLYes;
+        proto = MLSend(proto, "proto");
+    } while (proto != MLNull);
+    return MLNo;
+}
+
+static MLVariable MLObjectIsMutable(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    bool const isMutable = self->retainCountAndFlags & MLMutableFlag;
+    return MLBoolean(isMutable);
+}
+
+static MLVariable MLObjectRespondsTo(struct MLObject* self, MLVariable super, MLVariable command, MLVariable commandToCheck, MLVariable options, ...) {
+    // TODO: optimize.
+    MLVariable lookedUpSuper = MLZero;
+    void* code = MLLookup(self, commandToCheck, &lookedUpSuper);
+    return MLBoolean(code != MLZero);
+}
+
+static MLVariable MLObjectAsString(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLObject) return MLObjectClassName;
+    // TODO: put in the address of the object.
+    return MLString("<Object XXX>");
+}
+
+static MLVariable MLObjectSelf(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return self;
+}
+
+static MLVariable MLObjectHash(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLNumber((MLNatural)self);
+}
+
+static MLVariable MLObjectEquals(struct MLObject* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    return MLBooleanMake(self == object);
+}
+
+static MLVariable MLObjectAddMethodBlock(struct MLObject* self, MLVariable super, MLVariable command, MLVariable method, MLVariable block, MLVariable options, ...) {
+    if (self->meta->owner != self) {
+        struct MLObject* parent = self->meta->owner;
+
+        self->meta = calloc(1, sizeof(struct MLMeta));
+        self->meta->owner = self;
+        self->meta->parent = parent;
+
+        MLTableCreate(&self->meta->cache, parent->meta->cache.count);
+        MLTableCreate(&self->meta->methods, MLMethodsDefaultCapacity);
+        MLTableCreate(&self->meta->children, MLChildrenDefaultCapacity);
+
+        struct MLEntry entry = {.key = (MLNatural)self, .value = (MLNatural)MLYes};
+        MLTablePut(&parent->meta->children, &entry, MLZero, MLZero);
+    }
+
+    struct MLEntry entry = {.key = (MLNatural)method, .value = (MLNatural)block(block).code};
+    MLTablePut(&self->meta->methods, &entry, MLZero, MLZero);
+    MLObjectEternize(method, MLObject, NULL, NULL);
+
+    // TODO: clear cache of all children.
+
+    return self;
+}
+
+static MLVariable MLObjectRemoveMethod(struct MLObject* self, MLVariable super, MLVariable command, MLVariable method, MLVariable options, ...) {
+    // TODO: implement.
+    return MLNull;
+}
+
+static MLVariable MLObjectProto(struct MLObject* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    struct MLObject* parent = self->meta->parent;
+    struct MLObject* owner = self->meta->owner;
+    return owner == self ? parent : owner;
+}
+
+static MLVariable MLObjectSetProto(struct MLObject* self, MLVariable super, MLVariable command, MLVariable proto, MLVariable options, ...) {
+    // TODO: implement.
+    return MLNull;
+}
+
+static MLVariable MLObjectWarn(struct MLObject* self, MLVariable super, MLVariable command, MLVariable message, MLVariable options, ...) {
+    MLVariable description = MLSend(message, "as-string");
+    fprintf(stderr, "[WARNING] %.*s\n", (int)string(description).length, MLStringCharacters(description));
+    return self;
+}
+
+static MLVariable MLObjectFail(struct MLObject* self, MLVariable super, MLVariable command, MLVariable message, MLVariable options, ...) {
+    MLRaise(message);
+    return self;
+}
+
+static MLVariable MLObjectDebug(struct MLObject* self, MLVariable super, MLVariable command, MLVariable message, MLVariable options, ...) {
+    MLVariable description = MLSend(message, "as-string");
+    fprintf(stderr, "[DEBUG] %.*s\n", (int)string(description).length, MLStringCharacters(description));
+    return self;
+}
+
+// ------------------------------------------------------ Boolean Methods ------
+
+static MLVariable MLBooleanCreate(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLSend(self, "fail*", MLString("InvalidCommandException | Can't create a Boolean"));
+    return MLNull;
+}
+
+static MLVariable MLBooleanDestroy(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLSend(self, "fail*", MLString("InvalidCommandException | Can't destroy a Boolean"));
+    return MLNull;
+}
+
+static MLVariable MLBooleanAsString(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLBoolean) return MLBooleanClassName;
+    if (self == MLYes) return MLYesAsString;
+    if (self == MLNo) return MLNoAsString;
+
+    MLSend(self, "fail*", MLString("MLInternalInconsistencyException | Can't return boolean as-string, self is neither MLYes, nor MLNo, nor Boolean"));
+    return MLNull;
+}
+
+static MLVariable MLBooleanCompare(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    if (self == MLBoolean) return MLNull;
+    if (object != MLYes && object != MLNo) return MLNull;
+
+    if (self == MLNo && object == MLYes) return MLNumber(-1);
+    if (self == MLYes && object == MLNo) return MLNumber(+1);
+
+    return MLNumber(0);
+}
+
+static MLVariable MLBooleanCopy(struct MLBoolean* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return self;
+}
+
+// ------------------------------------------------------- Number Methods ------
+
+static MLVariable MLNumberCreate(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLSend(self, "fail*", MLString("InvalidCommandException | Can't create a Number"));
+    return MLNull;
+}
+
+static MLVariable MLNumberAsString(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLNumber) return MLNumberClassName;
+
+    char buffer[MLNumberFormatMaximumLength];
+    MLInteger const length = MLNumberFormat(self->number, buffer);
+
+   MLVariable const string = MLStringMake(length, buffer);
+    return MLSend(string, "collect");
+}
+
+static MLVariable MLNumberParseString(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable string, MLVariable options, ...) {
+    if (MLSend(string, "is-kind-of*", MLString) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't parse X as a number, it is not a string"));
+    }
+
+    // String literals include their trailing '\0', any other one is invalid:
+    struct MLString* const source = string;
+    char const* const characters = MLStringCharacters(source);
+    MLInteger const length = source->length > 0 && characters[source->length - 1] == '\0' ? source->length - 1 : source->length;
+    MLDecimal number = 0;
+
+    if (length <= 0 || memchr(characters, '\0', length) != MLZero || !MLNumberParse(length, characters, &number)) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't parse X as a number"));
+    }
+
+    return MLNumber(number);
+}
+
+static MLVariable MLNumberHash(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return self;
+}
+
+static MLVariable MLNumberEquals(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    return MLDecimalFrom(self) == MLDecimalFrom(object) ? MLYes : MLNo;
+}
+
+static MLVariable MLNumberCompare(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    MLDecimal const number1 = MLDecimalFrom(self);
+    MLDecimal const number2 = MLDecimalFrom(object);
+
+    if (number1 < number2) return MLNumber(-1);
+    if (number1 > number2) return MLNumber(+1);
+
+    return MLNumber(0);
+}
+
+static MLVariable MLNumberCopy(struct MLNumber* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLSend(self, "retain");
+}
+
+// -------------------------------------------------------- Block Methods ------
+
+static MLVariable MLBlockCreate(struct MLBlock* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLSend(self, "fail*", MLString("InvalidCommandException | Can't create a Block"));
+    return MLNull;
+}
+
+static MLVariable MLBlockAsString(struct MLBlock* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLBlock) return MLBlockClassName;
+
+    static struct MLString* string = MLZero;
+    if (string == MLZero) {
+        // TODO: put in the address of the block.
+        string = MLStringUncollected("<Block XXX>");
+        MLSend(string, "eternize");
+    }
+    return string;
+}
+
+static void MLFutureRunChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    struct MLFuture* const future = job->context;
+    MLVariable const result = job->code(job->block, MLZero, MLZero, future->argument, MLZero);
+    job->results[0] = MLSend(result, "retain");
+}
+
+// Runs the block on `argument` on the pool and returns a Future for its result
+// right away. Like blocks given to map*, it runs concurrently with the caller.
+static MLVariable MLBlockSpawn(struct MLBlock* self, MLVariable super, MLVariable command, MLVariable argument, MLVariable options, ...) {
+    struct MLFuture* const future = calloc(1, sizeof(struct MLFuture));
+    future->meta = &MLFutureMeta;
+    future->retainCountAndFlags = MLRetainCountOne;
+    future->argument = MLSend(argument, "retain");
+    future->job.function = MLFutureRunChunk;
+    future->job.block = MLSend(self, "retain");
+    future->job.code = self->code;
+    future->job.results = &future->result;
+    future->job.context = future;
+    future->job.chunkCount = 1;
+    future->job.remaining = 1;
+
+    MLPoolSubmit(MLPoolTaskMake(&future->job, 0, 1));
+    return MLCollectBlockAdd(future);
+}
+
+// ------------------------------------------------------- Future Methods ------
+
+static MLVariable MLFutureCreate(struct MLFuture* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLSend(self, "fail*", MLString("InvalidCommandException | Can't create a Future, spawn* a Block instead"));
+    return MLNull;
+}
+
+// The block may still be running, so wait for it before letting go:
+static MLVariable MLFutureDestroy(struct MLFuture* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLPoolWait(&self->job);
+    if (self->result != MLZero) MLSend(self->result, "release");
+    if (self->job.exception != MLZero) MLSend(self->job.exception, "release");
+    MLSend(self->argument, "release");
+    MLSend(self->job.block, "release");
+    return MLSuper(self, "destroy");
+}
+
+static MLVariable MLFutureAsString(struct MLFuture* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLFuture) return MLFutureClassName;
+    return MLFutureInstanceAsString;
+}
+
+static MLVariable MLFutureIsDone(struct MLFuture* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLBoolean(__atomic_load_n(&self->job.remaining, __ATOMIC_ACQUIRE) == 0);
+}
+
+// Waits for the block and returns its result, or raises its exception.
+static MLVariable MLFutureJoin(struct MLFuture* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLPoolWait(&self->job);
+    if (self->job.exception != MLZero) MLRaise(self->job.exception);
+    return self->result;
+}
+
+// --------------------------------------------------------- MLData Methods ------
+
+static MLVariable MLDataCreate(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLVariable mutable = MLOption("mutable", MLNo);
+    MLVariable capacity = MLOption("capacity", MLNumber(1));
+    MLVariable copy = MLOption("copy", MLNull);
+
+    // TODO: copy if needed.
+
+    self = MLSuper(self, "create", MLString("mutable"), mutable);
+    self->capacity = MLIntegerFrom(capacity);
+    self->capacity = MLMax(self->capacity, MLDataDefaultCapacity);
+    self->capacity = MLRoundUpToPowerOfTwo(self->capacity);
+    self->count = 0;
+    self->bytes = calloc(self->capacity, 1);
+
+    return self;
+}
+
+static MLVariable MLDataMap(struct MLData* self, MLVariable super, MLVariable command, MLVariable path, MLVariable options, ...) {
+    MLVariable access = MLOption("access", MLNull);
+
+    if (MLSend(path, "is-kind-of*", MLString) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't map file, path is not a string"));
+    }
+
+    // Path must be NUL-terminated for open(2), string literals already are:
+    struct MLString* string = path;
+    char const* characters = MLStringCharacters(string);
+    char* name = calloc(string->length + 1, 1);
+    memcpy(name, characters, strnlen(characters, string->length));
+
+    int advice = MADV_NORMAL;
+    if (access == MLNull) advice = MADV_NORMAL;
+    else if (MLSend(access, "equals*", MLString("sequential")) == MLYes) advice = MADV_SEQUENTIAL;
+    else if (MLSend(access, "equals*", MLString("random")) == MLYes) advice = MADV_RANDOM;
+    else if (MLSend(access, "equals*", MLString("will-need")) == MLYes) advice = MADV_WILLNEED;
+    else {
+        free(name);
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't map file, access X is not one of sequential, random, will-need"));
+    }
+
+    int const descriptor = open(name, O_RDONLY);
+    free(name);
+    if (descriptor < 0) {
+        MLSend(self, "fail*", MLString("IOException | Can't map file X, it can't be opened"));
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+        close(descriptor);
+        MLSend(self, "fail*", MLString("IOException | Can't map file X, it is not a regular file"));
+    }
+
+    // mmap(2) rejects empty mappings, an empty file is just empty data:
+    if (status.st_size == 0) {
+        close(descriptor);
+        return MLCollectBlockAdd(MLDataMake(0, ""));
+    }
+
+    void* bytes = mmap(MLZero, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (bytes == MAP_FAILED) {
+        MLSend(self, "fail*", MLString("IOException | Can't map file X, mmap failed"));
+    }
+
+    if (advice != MADV_NORMAL) madvise(bytes, status.st_size, advice);
+
+    struct MLData* data = calloc(1, sizeof(struct MLData));
+    data->meta = &MLDataMeta;
+    data->retainCountAndFlags = MLRetainCountOne | MLMappedFlag;
+    data->capacity = -1;
+    data->count = status.st_size;
+    data->bytes = bytes;
+    return MLCollectBlockAdd(data);
+}
+
+static MLVariable MLDataDestroy(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self->parent != MLZero) MLBufferDetach((struct MLBuffer*)self);
+    else if (self->retainCountAndFlags & MLMappedFlag) munmap(self->bytes, self->count);
+    else free(self->bytes);
+
+    return MLSuper(self, "destroy");
+}
+
+static MLVariable MLDataAsString(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLData) return MLDataClassName;
+    return MLSend(self, "base64");
+}
+
+static MLVariable MLDataBase64(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLInteger const length = (self->count + 2) / 3 * 4;
+    char* const characters = malloc(length + 1);
+    MLBase64Encode(self->bytes, self->count, characters);
+    return MLCollectBlockAdd(MLStringTake(length, characters));
+}
+
+static MLVariable MLDataHex(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLInteger const length = self->count * 2;
+    char* const characters = malloc(length + 1);
+    MLHexEncode(self->bytes, self->count, characters);
+    return MLCollectBlockAdd(MLStringTake(length, characters));
+}
+
+static MLVariable MLDataDecodeBase64(struct MLData* self, MLVariable super, MLVariable command, MLVariable string, MLVariable options, ...) {
+    if (MLSend(string, "is-kind-of*", MLString) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't decode X, it is not a string"));
+    }
+
+    // String literals include their trailing '\0':
+    char const* const characters = MLStringCharacters(string);
+    MLInteger const length = strnlen(characters, string(string).length);
+    uint8_t* const bytes = malloc(length / 4 * 3 + MLCodecSlack);
+    MLInteger const count = MLBase64Decode(characters, length, bytes);
+
+    if (count < 0) {
+        free(bytes);
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't decode X, it is not Base64"));
+    }
+
+    return MLCollectBlockAdd(MLDataTake(count, bytes));
+}
+
+static MLVariable MLDataDecodeHex(struct MLData* self, MLVariable super, MLVariable command, MLVariable string, MLVariable options, ...) {
+    if (MLSend(string, "is-kind-of*", MLString) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't decode X, it is not a string"));
+    }
+
+    char const* const characters = MLStringCharacters(string);
+    MLInteger const length = strnlen(characters, string(string).length);
+    uint8_t* const bytes = malloc(length / 2 + MLCodecSlack);
+    MLInteger const count = MLHexDecode(characters, length, bytes);
+
+    if (count < 0) {
+        free(bytes);
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't decode X, it is not hex"));
+    }
+
+    return MLCollectBlockAdd(MLDataTake(count, bytes));
+}
+
+static MLVariable MLDataHash(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLHashNumber(MLDataHashValue(self));
+}
+
+static MLVariable MLDataEquals(struct MLData* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    if (self == object) return MLYes;
+    if (MLSend(object, "is-kind-of*", MLData) == MLNo) return MLNo;
+
+    struct MLData* data1 = self;
+    struct MLData* data2 = object;
+
+    if (data1->count != data2->count) return MLNo;
+
+    MLInteger const result = memcmp(data1->bytes, data2->bytes, data1->count);
+    return result == 0 ? MLYes : MLNo;
+}
+
+// A copy of mutable data is a view of all of it, which gets its own bytes
+// only once the data changes.
+static MLVariable MLDataCopy(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self->capacity < 0) return MLSend(self, "retain");
+    return MLSend(MLSend(self, "at*count*", MLNumber(0), MLNumber(self->count)), "retain");
+}
+
+static MLVariable MLDataAtCount(struct MLData* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable options, ...) {
+    MLInteger const MLIntegerIndex = MLIntegerFrom(index);
+    MLInteger const MLIntegerCount = MLIntegerFrom(count);
+
+    // Validate arguments:
+    if (MLIntegerIndex < 0 || MLIntegerIndex > self->count) {
+        MLSend(self, "fail*", MLString("RangeException | Can't return X bytes at index Y, index Y is out of range [0, B]"));
+    }
+
+    if (MLIntegerCount < 0) {
+        MLSend(self, "fail*", MLString("RangeException | Can't return X bytes at index Y, count X out of range [0, ∞]"));
+    }
+
+    MLInteger const revisedCount = MLMin(self->count - MLIntegerIndex, MLIntegerCount);
+    char* const bytes = self->bytes;
+
+    if (MLBufferShouldCopySlice((struct MLBuffer*)self, revisedCount)) {
+        return MLCollectBlockAdd(MLDataMake(revisedCount, bytes + MLIntegerIndex));
+    }
+
+    return MLCollectBlockAdd(MLBufferViewMake((struct MLBuffer*)self, &MLDataMeta, sizeof(struct MLData), MLIntegerIndex, revisedCount));
+}
+
+static MLVariable MLDataReplaceAtCountWith(struct MLData* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable data, MLVariable options, ...) {
+    MLInteger const MLIntegerIndex = MLIntegerFrom(index);
+    MLInteger const MLIntegerCount = MLIntegerFrom(count);
+
+    // Make sure data is mutable:
+    if (MLSend(self, "is-mutable") == MLNo) {
+        MLSend(self, "fail*", MLString("ImmutableException | Can't replace X bytes at index Y with Z, object isn't mutable"));
+    }
+
+    // Validate arguments:
+    if (MLIntegerIndex < 0 || MLIntegerIndex > self->count) {
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X bytes at index Y with Z, index Y is out of range [0, B]"));
+    }
+
+    if (MLIntegerCount < 0) {
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X bytes at index Y with Z, count Y out of range [0, ∞]"));
+    }
+
+    if (MLSend(data, "is-kind-of*", MLData) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't replace X bytes at index Y with Z, Z isn't a Data"));
+    }
+
+    // Views of the current bytes must not see them change:
+    MLBufferMaterializeViews((struct MLBuffer*)self);
+
+    // Gather information:
+    struct MLData* const replacement = data;
+    MLInteger const revisedCount = MLMin(self->count - MLIntegerIndex, MLIntegerCount);
+    MLInteger const requiredCapacity = self->count + replacement->count - revisedCount;
+
+    // Replacing a range with the whole object itself needs a copy of the original:
+    void* const source = replacement == self ? memcpy(malloc(self->count + 1), self->bytes, self->count) : replacement->bytes;
+
+    // Ensure enough capacity, then make room for and copy in the new bytes:
+    MLDataEnsureCapacity(self, requiredCapacity);
+
+    char* const bytes = self->bytes;
+    memmove(bytes + MLIntegerIndex + replacement->count, bytes + MLIntegerIndex + revisedCount, self->count - MLIntegerIndex - revisedCount);
+    memmove(bytes + MLIntegerIndex, source, replacement->count);
+    if (replacement == self) free(source);
+
+    // Update own properties, the cached hash is stale now:
+    self->count = requiredCapacity;
+    self->hash = 0;
+    self->mutations += 1;
+
+    // Done.
+    return self;
+}
+
+// Enumerates the bytes as numbers, which are eternal and never allocated.
+static MLVariable MLDataEnumerate(struct MLData* self, MLVariable super, MLVariable command, struct MLEnumeration* enumeration, MLVariable options, ...) {
+    if (enumeration->state == 0) {
+        enumeration->mutations = &self->mutations;
+        enumeration->mutationsSeen = self->mutations;
+    }
+
+    uint8_t const* const bytes = self->bytes;
+    MLInteger const start = enumeration->state;
+    MLInteger const count = MLMin(self->count - start, MLEnumerationBufferCount);
+
+    for (MLInteger i = 0; i < count; i += 1) enumeration->buffer[i] = &MLByteNumbers[bytes[start + i]];
+
+    enumeration->objects = enumeration->buffer;
+    enumeration->count = count;
+    enumeration->state = start + count;
+
+    return MLBoolean(count > 0);
+}
+
+static MLVariable MLDataCount(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLNumber(self->count);
+}
+
+// -------------------------------------------------------- Array Methods ------
+
+static MLVariable MLArrayCreate(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLVariable mutable = MLOption("mutable", MLNo);
+    MLVariable capacity = MLOption("capacity", MLNumber(1));
+    MLVariable copy = MLOption("copy", MLNull);
+
+    // TODO: copy if needed.
+
+    self = MLSuper(self, "create", MLString("mutable"), mutable);
+    self->capacity = MLIntegerFrom(capacity);
+    self->capacity = MLMax(self->capacity, MLArrayDefaultCapacity);
+    self->capacity = MLRoundUpToPowerOfTwo(self->capacity);
+    self->count = 0;
+    self->objects = calloc(self->capacity, sizeof(MLVariable));
+
+    return self;
+}
+
+static MLVariable MLArrayDestroy(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (MLShareLeave(&self->shares)) {
+        MLReleaseMany(self->count, self->objects);
+        free(self->objects - self->head);
+    }
+    return MLSuper(self, "destroy");
+}
+
+static MLVariable MLArrayAsString(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLArray) return MLArrayClassName;
+    return MLString("<Array XXX>");
+}
+
+static MLVariable MLArrayHash(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLHashNumber(MLArrayHashValue(self));
+}
+
+// Arrays whose hashes are known and differ aren't equal, without looking at
+// any of their objects.
+static MLVariable MLArrayEquals(struct MLArray* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    if (self == object) return MLYes;
+    if (MLSend(object, "is-kind-of*", MLArray) == MLNo) return MLNo;
+
+    struct MLArray* array1 = self;
+    struct MLArray* array2 = object;
+
+    if (array1->count != array2->count) return MLNo;
+
+    MLNatural const hash1 = __atomic_load_n(&array1->hash, __ATOMIC_RELAXED);
+    MLNatural const hash2 = __atomic_load_n(&array2->hash, __ATOMIC_RELAXED);
+    if (hash1 != 0 && hash2 != 0 && hash1 != hash2) return MLNo;
+
+    for (int index = 0; index < array1->count; index += 1) {
+        MLVariable object1 = array1->objects[index];
+        MLVariable object2 = array2->objects[index];
+        if (object1 != object2 && MLSend(object1, "equals*", object2) == MLNo) return MLNo;
+    }
+
+    return MLYes;
+}
+
+// Copies share the objects until either array changes, see MLArrayDetach().
+static MLVariable MLArrayCopy(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLVariable mutable = MLOption("mutable", MLNo);
+    bool const isMutable = self->retainCountAndFlags & MLMutableFlag;
+    if (!isMutable && mutable == MLNo) return MLSend(self, "retain");
+
+    struct MLArray* copy = calloc(1, sizeof(struct MLArray));
+    copy->meta = self->meta;
+    copy->retainCountAndFlags = MLRetainCountOne | (mutable == MLYes ? MLMutableFlag : 0);
+    copy->capacity = mutable == MLYes ? self->count : -1;
+    copy->count = self->count;
+    copy->hash = self->hash;
+    copy->objects = self->objects;
+    copy->head = self->head;
+    copy->shares = MLShareJoin(&self->shares);
+
+    return copy;
+}
+
+static MLVariable MLArrayAt(struct MLArray* self, MLVariable super, MLVariable command, MLVariable index, MLVariable options, ...) {
+    MLInteger const MLIntegerIndex = MLIntegerFrom(index);
+    MLInteger const MLIntegerCount = self->count;
+
+    if (MLIntegerIndex < 0 || MLIntegerIndex >= MLIntegerCount) {
+        MLSend(self, "fail*", MLString("RangeException | Can't access object at index X"));
+    }
+
+    return self->objects[MLIntegerIndex];
+}
+
+// Hands out all objects at once, right out of the array.
+static MLVariable MLArrayEnumerate(struct MLArray* self, MLVariable super, MLVariable command, struct MLEnumeration* enumeration, MLVariable options, ...) {
+    bool const isFirst = enumeration->state == 0;
+
+    if (isFirst) {
+        enumeration->mutations = &self->mutations;
+        enumeration->mutationsSeen = self->mutations;
+    }
+
+    enumeration->objects = self->objects;
+    enumeration->count = isFirst ? self->count : 0;
+    enumeration->state = 1;
+
+    return MLBoolean(enumeration->count > 0);
+}
+
+static MLVariable MLArrayCount(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLNumber(self->count);
+}
+
+// Blocks given to map*, filter*, reduce*with* and each* are called like
+// methods, with the block as `self`. Large arrays are processed in chunks on
+// the thread pool, so blocks must be safe to run concurrently.
+
+static void MLArrayMapChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    for (MLInteger i = start; i < end; i += 1) {
+        MLVariable const result = job->code(job->block, MLZero, MLZero, job->array->objects[i], MLZero);
+        job->results[i] = MLSend(result, "retain");
+    }
+}
+
+static void MLArrayFilterChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    for (MLInteger i = start; i < end; i += 1) {
+        job->results[i] = job->code(job->block, MLZero, MLZero, job->array->objects[i], MLZero);
+    }
+}
+
+static void MLArrayReduceChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    MLVariable accumulator = job->array->objects[start];
+
+    for (MLInteger i = start + 1; i < end; i += 1) {
+        accumulator = job->code(job->block, MLZero, MLZero, accumulator, job->array->objects[i], MLZero);
+    }
+
+    job->results[start / job->chunkCount] = MLSend(accumulator, "retain");
+}
+
+static void MLArrayEachChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    for (MLInteger i = start; i < end; i += 1) {
+        job->code(job->block, MLZero, MLZero, job->array->objects[i], MLZero);
+    }
+}
+
+// Releases whatever results the job left behind and raises its exception.
+static void MLArrayFinishJob(struct MLJob* job, MLInteger resultsCount, bool isRetained) {
+    for (MLInteger i = 0; isRetained && i < resultsCount; i += 1) {
+        if (job->results[i] != MLZero) MLSend(job->results[i], "release");
+    }
+
+    free(job->results);
+    MLRaise(MLCollectBlockAdd(job->exception));
+}
+
+static MLVariable MLArrayMap(struct MLArray* self, MLVariable super, MLVariable command, MLVariable block, MLVariable options, ...) {
+    if (MLSend(block, "is-kind-of*", MLBlock) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't map objects with X, X isn't a Block"));
+    }
+
+    struct MLJob job = {.function = MLArrayMapChunk, .array = self, .block = block, .code = block(block).code};
+    job.results = calloc(MLMax(self->count, 1), sizeof(MLVariable));
+    MLPoolRun(&job);
+
+    if (job.exception != MLZero) MLArrayFinishJob(&job, self->count, true);
+    return MLCollectBlockAdd(MLArrayTake(self->count, job.results));
+}
+
+// Keeps the objects for which the block returns MLYes, in their order.
+static MLVariable MLArrayFilter(struct MLArray* self, MLVariable super, MLVariable command, MLVariable block, MLVariable options, ...) {
+    if (MLSend(block, "is-kind-of*", MLBlock) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't filter objects with X, X isn't a Block"));
+    }
+
+    struct MLJob job = {.function = MLArrayFilterChunk, .array = self, .block = block, .code = block(block).code};
+    job.results = calloc(MLMax(self->count, 1), sizeof(MLVariable));
+    MLPoolRun(&job);
+
+    if (job.exception != MLZero) MLArrayFinishJob(&job, self->count, false);
+
+    MLInteger count = 0;
+    for (MLInteger i = 0; i < self->count; i += 1) {
+        if (job.results[i] == MLYes) job.results[count++] = self->objects[i];
+    }
+
+    MLRetainMany(count, job.results);
+
+    return MLCollectBlockAdd(MLArrayTake(count, job.results));
+}
+
+// Chunks are reduced in parallel and their results combined in order,
+// starting with `initial`, so the block must be associative.
+static MLVariable MLArrayReduceWith(struct MLArray* self, MLVariable super, MLVariable command, MLVariable initial, MLVariable block, MLVariable options, ...) {
+    if (MLSend(block, "is-kind-of*", MLBlock) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't reduce objects with X, X isn't a Block"));
+    }
+
+    struct MLJob job = {.function = MLArrayReduceChunk, .array = self, .block = block, .code = block(block).code};
+    job.results = calloc(MLMax(self->count, 1), sizeof(MLVariable));
+    MLPoolRun(&job);
+
+    MLInteger const chunksCount = (self->count + job.chunkCount - 1) / job.chunkCount;
+    if (job.exception != MLZero) MLArrayFinishJob(&job, chunksCount, true);
+
+    MLVariable accumulator = initial;
+    for (MLInteger i = 0; i < chunksCount; i += 1) {
+        accumulator = job.code(block, MLZero, MLZero, accumulator, job.results[i], MLZero);
+        MLCollectBlockAdd(job.results[i]);
+    }
+
+    free(job.results);
+    return accumulator;
+}
+
+static MLVariable MLArrayEach(struct MLArray* self, MLVariable super, MLVariable command, MLVariable block, MLVariable options, ...) {
+    if (MLSend(block, "is-kind-of*", MLBlock) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't run X for each object, X isn't a Block"));
+    }
+
+    struct MLJob job = {.function = MLArrayEachChunk, .array = self, .block = block, .code = block(block).code};
+    MLPoolRun(&job);
+
+    if (job.exception != MLZero) MLArrayFinishJob(&job, 0, false);
+    return self;
+}
+
+static void MLArraySortChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    struct MLSort* const sort = job->context;
+    sort->sortRange(sort, sort->source + start, sort->target + start, end - start);
+}
+
+// Merges output positions [start, end) of the current round, they may span
+// several pairs of ranges when the ranges are narrower than a chunk.
+static void MLArraySortMergeChunk(struct MLJob* job, MLInteger start, MLInteger end) {
+    struct MLSort* const sort = job->context;
+
+    for (MLInteger pairStart = start - start % (2 * sort->width); pairStart < end; pairStart += 2 * sort->width) {
+        MLInteger const middle = MLMin(pairStart + sort->width, sort->count);
+        MLInteger const pairEnd = MLMin(pairStart + 2 * sort->width, sort->count);
+        MLInteger const from = MLMax(start, pairStart);
+        MLInteger const to = MLMin(end, pairEnd);
+        sort->mergeRange(sort, sort->source + pairStart, middle - pairStart, sort->source + middle, pairEnd - middle, from - pairStart, to - pairStart, sort->target + from);
+    }
+}
+
+// Chunks are sorted on the thread pool, then merged pairwise in rounds that
+// are split across the pool as well. Numbers and strings are compared by key
+// when all objects are of one kind, anything else through compare*.
+static MLVariable MLArraySortWith(struct MLArray* self, MLVariable block) {
+    MLInteger const count = self->count;
+    struct MLSort sort = {.block = block, .count = count};
+    sort.source = malloc(MLMax(count, 1) * sizeof(struct MLSortEntry));
+    sort.target = malloc(MLMax(count, 1) * sizeof(struct MLSortEntry));
+
+    bool areNumbers = block == MLZero;
+    bool areStrings = block == MLZero;
+    for (MLInteger i = 0; i < count; i += 1) {
+        areNumbers = areNumbers && object(self->objects[i]).meta == &MLNumberMeta;
+        areStrings = areStrings && object(self->objects[i]).meta == &MLStringMeta;
+        sort.source[i].object = self->objects[i];
+    }
+
+    if (block != MLZero) {
+        sort.code = block(block).code;
+        sort.sortRange = MLSortRangeBlock;
+        sort.mergeRange = MLSortMergeRangeBlock;
+    }
+    else if (areNumbers) {
+        for (MLInteger i = 0; i < count; i += 1) sort.source[i].number = MLDecimalFrom(sort.source[i].object);
+        sort.sortRange = MLSortRangeNumbers;
+        sort.mergeRange = MLSortMergeRangeNumbers;
+    }
+    else if (areStrings) {
+        for (MLInteger i = 0; i < count; i += 1) {
+            sort.source[i].characters = MLStringCharacters(sort.source[i].object);
+            sort.source[i].length = ((struct MLString*)sort.source[i].object)->length;
+        }
+        sort.sortRange = MLSortRangeStrings;
+        sort.mergeRange = MLSortMergeRangeStrings;
+    }
+    else {
+        sort.sortRange = MLSortRangeObjects;
+        sort.mergeRange = MLSortMergeRangeObjects;
+    }
+
+    struct MLJob job = {.function = MLArraySortChunk, .array = self, .block = block, .code = sort.code, .context = &sort};
+    MLPoolRun(&job);
+
+    job.function = MLArraySortMergeChunk;
+    for (sort.width = job.chunkCount; job.exception == MLZero && sort.width < count; sort.width *= 2) {
+        MLPoolRun(&job);
+        struct MLSortEntry* const entries = sort.source;
+        sort.source = sort.target;
+        sort.target = entries;
+    }
+
+    free(sort.target);
+    if (job.exception != MLZero) {
+        free(sort.source);
+        MLArrayFinishJob(&job, 0, false);
+    }
+
+    MLVariable* objects = malloc(MLMax(count, 1) * sizeof(MLVariable));
+    for (MLInteger i = 0; i < count; i += 1) objects[i] = sort.source[i].object;
+    MLRetainMany(count, objects);
+    free(sort.source);
+
+    return MLCollectBlockAdd(MLArrayTake(count, objects));
+}
+
+static MLVariable MLArraySort(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLArraySortWith(self, MLZero);
+}
+
+// The block is called with two objects and returns a negative number when
+// the first goes before the second, like compare*.
+static MLVariable MLArraySortBy(struct MLArray* self, MLVariable super, MLVariable command, MLVariable block, MLVariable options, ...) {
+    if (MLSend(block, "is-kind-of*", MLBlock) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't sort objects with X, X isn't a Block"));
+    }
+
+    return MLArraySortWith(self, block);
+}
+
+static MLVariable MLArrayReplaceAtCountWith(struct MLArray* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable objects, MLVariable options, ...) {
+    MLInteger const MLIntegerIndex = MLIntegerFrom(index);
+    MLInteger const MLIntegerCount = MLIntegerFrom(count);
+
+    // Make sure array is mutable:
+    if (MLSend(self, "is-mutable") == MLNo) {
+        MLSend(self, "fail*", MLString("ImmutableException | Can't replace X objects at index Y with Z, object isn't mutable"));
+    }
+
+    // Validate arguments:
+    if (MLIntegerIndex < 0 || MLIntegerIndex > self->count) {
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X objects at index Y with Z, index Y is out of range [0, B]"));
+    }
+
+    if (MLIntegerCount < 0) {
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X objects at index Y with Z, count Y out of range [0, ∞]"));
+    }
+
+    // Gather information:
+    MLInteger const revisedCount = MLMin(self->count - MLIntegerIndex, MLIntegerCount);
+    bool const isArray = MLSend(objects, "is-kind-of*", MLArray) == MLYes;
+    MLInteger const countOfObjects = isArray ? ((struct MLArray*)objects)->count : MLIntegerFrom(MLSend(objects, "count"));
+    MLInteger const requiredCapacity = self->count + countOfObjects - revisedCount;
+
+    // Arrays are read in place, replacing with the array itself or anything else needs a copy first:
+    bool const copied = !isArray || objects == self;
+    MLVariable* const source = copied ? malloc(MLMax(countOfObjects, 1) * sizeof(MLVariable)) : ((struct MLArray*)objects)->objects;
+
+    if (objects == self) {
+        memcpy(source, self->objects, countOfObjects * sizeof(MLVariable));
+    }
+    else if (!isArray) {
+        for (MLInteger k = 0; k < countOfObjects; k += 1) source[k] = MLSend(objects, "at*", MLNumber(k));
+    }
+
+    // Objects shared with copies must not change under them:
+    MLArrayDetach(self);
+
+    // Retain new objects before releasing the replaced ones, they may be the same:
+    MLRetainMany(countOfObjects, source);
+    MLReleaseMany(revisedCount, self->objects + MLIntegerIndex);
+
+    // Make room by moving whichever side of the range has fewer objects, the
+    // front moves into (or out of) the free slots before the objects:
+    MLInteger const difference = countOfObjects - revisedCount;
+    MLInteger const tailCount = self->count - MLIntegerIndex - revisedCount;
+
+    if (difference != 0 && MLIntegerIndex < tailCount) {
+        if (self->head < difference) MLArrayEnsureHead(self, difference);
+        memmove(self->objects - difference, self->objects, MLIntegerIndex * sizeof(MLVariable));
+        self->objects -= difference;
+        self->head -= difference;
+        self->capacity += difference;
+    }
+    else {
+        if (self->capacity < requiredCapacity) MLArrayEnsureCapacity(self, requiredCapacity);
+        memmove(self->objects + MLIntegerIndex + countOfObjects, self->objects + MLIntegerIndex + revisedCount, tailCount * sizeof(MLVariable));
+    }
+
+    memcpy(self->objects + MLIntegerIndex, source, countOfObjects * sizeof(MLVariable));
+    if (copied) free(source);
 
-static MLVariable MLDataReplaceAtCountWith(struct MLData* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable data, MLVariable options, ...) {
-    // TODO: implement.
-    return self;
-}
+    // Update own properties, the cached hash is stale now:
+    self->count = requiredCapacity;
+    self->hash = 0;
+    self->mutations += 1;
 
-static MLVariable MLDataCount(struct MLData* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    return MLNumber(self->count);
+    // Done.
+    return self;
 }
 
-// -------------------------------------------------------- Array Methods ------
+// ------------------------------------------------- Number Array Methods ------
 
-static MLVariable MLArrayCreate(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+static MLVariable MLNumberArrayCreate(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
     MLVariable mutable = MLOption("mutable", MLNo);
     MLVariable capacity = MLOption("capacity", MLNumber(1));
-    MLVariable copy = MLOption("copy", MLNull);
-
-    // TODO: copy if needed.
+    MLVariable integer = MLOption("integer", MLNo);
 
     self = MLSuper(self, "create", MLString("mutable"), mutable);
     self->capacity = MLIntegerFrom(capacity);
-    self->capacity = MLMax(self->capacity, MLArrayDefaultCapacity);
+    self->capacity = MLMax(self->capacity, MLNumberArrayDefaultCapacity);
     self->capacity = MLRoundUpToPowerOfTwo(self->capacity);
     self->count = 0;
-    self->objects = calloc(self->capacity, sizeof(MLVariable));
+    self->isInteger = integer == MLYes;
+    self->values = calloc(self->capacity, sizeof(double));
 
     return self;
 }
 
-static MLVariable MLArrayDestroy(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    for (int i = 0; i < self->count; i += 1) {
-        MLSend(self->objects[i], "release");
-    }
-    free(self->objects);
+static MLVariable MLNumberArrayDestroy(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    free(self->values);
     return MLSuper(self, "destroy");
 }
 
-static MLVariable MLArrayAsString(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self == MLArray) return MLArrayClassName;
-    return MLString("<Array XXX>");
+static MLVariable MLNumberArrayAsString(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLNumberArray) return MLNumberArrayClassName;
+
+    // Numbers are formatted like Number as-string, e.g. "[1, 2.5, -3]":
+    char* const characters = malloc(self->count * (MLNumberFormatMaximumLength + 2) + 3);
+    MLInteger length = 0;
+
+    characters[length++] = '[';
+    for (MLInteger i = 0; i < self->count; i += 1) {
+        if (i > 0) {
+            characters[length++] = ',';
+            characters[length++] = ' ';
+        }
+        length += MLNumberFormat(self->isInteger ? (MLDecimal)self->integers[i] : self->decimals[i], characters + length);
+    }
+    characters[length++] = ']';
+
+    return MLCollectBlockAdd(MLStringTake(length, characters));
 }
 
-static MLVariable MLArrayHash(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    // TODO: implement.
-    return MLNull;
+static MLVariable MLNumberArrayHash(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLHashNumber(MLDigest(self->count * sizeof(double), self->values));
 }
 
-static MLVariable MLArrayEquals(struct MLArray* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+static MLVariable MLNumberArrayEquals(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
     if (self == object) return MLYes;
-    if (MLSend(object, "is-kind-of*", MLArray) == MLNo) return MLNo;
-
-    struct MLArray* array1 = self;
-    struct MLArray* array2 = object;
-
-    if (array1->count != array2->count) return MLNo;
+    if (MLSend(object, "is-kind-of*", MLNumberArray) == MLNo) return MLNo;
 
-    for (int index = 0; index < array1->count; index += 1) {
-        MLVariable object1 = array1->objects[index];
-        MLVariable object2 = array2->objects[index];
-        if (MLSend(object1, "equals*", object2) == MLNo) return MLNo;
-    }
+    struct MLNumberArray* array1 = self;
+    struct MLNumberArray* array2 = object;
 
-    return MLYes;
-}
+    if (array1->isInteger != array2->isInteger || array1->count != array2->count) return MLNo;
 
-static MLVariable MLArrayCopy(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLVariable mutable = MLOption(MLString("mutable"), MLNo);
-    // TODO: don't copy if mutable = MLNo and object is immutable
-    return MLSend(self, "create", MLOptions(MLString("mutable"), mutable, MLString("copy"), MLYes));
+    MLInteger const result = memcmp(array1->values, array2->values, array1->count * sizeof(double));
+    return result == 0 ? MLYes : MLNo;
 }
 
-static MLVariable MLArrayAt(struct MLArray* self, MLVariable super, MLVariable command, MLVariable index, MLVariable options, ...) {
+static MLVariable MLNumberArrayAt(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable index, MLVariable options, ...) {
     MLInteger const MLIntegerIndex = MLIntegerFrom(index);
-    MLInteger const MLIntegerCount = self->count;
 
-    if (MLIntegerIndex < 0 || MLIntegerIndex >= MLIntegerCount) {
-        MLSend(self, "fail*", MLString("RangeException | Can't access object at index X"));
+    if (MLIntegerIndex < 0 || MLIntegerIndex >= self->count) {
+        MLSend(self, "fail*", MLString("RangeException | Can't access number at index X"));
     }
 
-    return self->objects[MLIntegerIndex];
+    return MLNumber(self->isInteger ? (MLDecimal)self->integers[MLIntegerIndex] : self->decimals[MLIntegerIndex]);
 }
 
-static MLVariable MLArrayCount(struct MLArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+static MLVariable MLNumberArrayCount(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
     return MLNumber(self->count);
 }
 
-static MLVariable MLArrayReplaceAtCountWith(struct MLArray* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable objects, MLVariable options, ...) {
+// Number arrays of the same kind are copied as they are, anything else is
+// read number by number, arrays straight from their object buffer.
+static MLVariable MLNumberArrayReplaceAtCountWith(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable numbers, MLVariable options, ...) {
     MLInteger const MLIntegerIndex = MLIntegerFrom(index);
     MLInteger const MLIntegerCount = MLIntegerFrom(count);
 
     // Make sure array is mutable:
     if (MLSend(self, "is-mutable") == MLNo) {
-        MLSend(self, "fail*", MLString("ImmutableException | Can't replace X objects at index Y with Z, object isn't mutable"));
+        MLSend(self, "fail*", MLString("ImmutableException | Can't replace X numbers at index Y with Z, object isn't mutable"));
     }
 
     // Validate arguments:
     if (MLIntegerIndex < 0 || MLIntegerIndex > self->count) {
-        MLSend(self, "fail*", MLString("RangeException | Can't replace X objects at index Y with Z, index Y is out of range [0, B]"));
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X numbers at index Y with Z, index Y is out of range [0, B]"));
     }
 
     if (MLIntegerCount < 0) {
-        MLSend(self, "fail*", MLString("RangeException | Can't replace X objects at index Y with Z, count Y out of range [0, ∞]"));
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X numbers at index Y with Z, count Y out of range [0, ∞]"));
     }
 
-    // Gather information:
+    // Gather the replacement as packed values of the same kind:
+    bool const isNumberArray = MLSend(numbers, "is-kind-of*", MLNumberArray) == MLYes;
+    bool const isArray = !isNumberArray && MLSend(numbers, "is-kind-of*", MLArray) == MLYes;
+    struct MLNumberArray* const replacement = numbers;
+    MLInteger const countOfNumbers = isNumberArray ? replacement->count : isArray ? ((struct MLArray*)numbers)->count : MLIntegerFrom(MLSend(numbers, "count"));
+
+    bool const copied = !isNumberArray || replacement == self || replacement->isInteger != self->isInteger;
+    void* const source = copied ? malloc(MLMax(countOfNumbers, 1) * sizeof(double)) : replacement->values;
+
+    for (MLInteger k = 0; copied && k < countOfNumbers; k += 1) {
+        MLDecimal const number = isNumberArray ? (replacement->isInteger ? (MLDecimal)replacement->integers[k] : replacement->decimals[k]) : MLDecimalFrom(isArray ? ((struct MLArray*)numbers)->objects[k] : MLSend(numbers, "at*", MLNumber(k)));
+        if (self->isInteger) ((int64_t*)source)[k] = (int64_t)number;
+        else ((double*)source)[k] = number;
+    }
+
+    // Ensure enough capacity, then make room for and copy in the new numbers:
     MLInteger const revisedCount = MLMin(self->count - MLIntegerIndex, MLIntegerCount);
-    MLInteger const countOfObjects = MLIntegerFrom(MLSend(objects, "count"));
-    MLInteger const requiredCapacity = self->count + countOfObjects - revisedCount;
+    MLInteger const requiredCapacity = self->count + countOfNumbers - revisedCount;
+    MLNumberArrayEnsureCapacity(self, requiredCapacity);
 
-    // Ensure enough capacity:
-    if (self->capacity < requiredCapacity) {
-        MLArrayEnsureCapacity(self, requiredCapacity);
+    double* const values = self->values;
+    memmove(values + MLIntegerIndex + countOfNumbers, values + MLIntegerIndex + revisedCount, (self->count - MLIntegerIndex - revisedCount) * sizeof(double));
+    memcpy(values + MLIntegerIndex, source, countOfNumbers * sizeof(double));
+    if (copied) free(source);
+
+    // Update own properties:
+    self->count = requiredCapacity;
+
+    // Done.
+    return self;
+}
+
+static MLVariable MLNumberArraySum(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self->isInteger) return MLNumber(MLVectorIntegersSum(self->count, self->integers));
+    return MLNumber(MLVectorDecimalsSum(self->count, self->decimals));
+}
+
+static MLVariable MLNumberArrayMin(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self->count == 0) return MLNull;
+    if (self->isInteger) return MLNumber(MLVectorIntegersExtreme(self->count, self->integers, false));
+    return MLNumber(MLVectorDecimalsExtreme(self->count, self->decimals, false));
+}
+
+static MLVariable MLNumberArrayMax(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self->count == 0) return MLNull;
+    if (self->isInteger) return MLNumber(MLVectorIntegersExtreme(self->count, self->integers, true));
+    return MLNumber(MLVectorDecimalsExtreme(self->count, self->decimals, true));
+}
+
+// Integer arrays are scaled by the integral part of the factor.
+static MLVariable MLNumberArrayScale(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable factor, MLVariable options, ...) {
+    if (MLSend(self, "is-mutable") == MLNo) {
+        MLSend(self, "fail*", MLString("ImmutableException | Can't scale numbers by X, object isn't mutable"));
     }
 
-    // Remove & release objects to be replaced:
-    for (MLInteger i = MLIntegerIndex; i < MLIntegerIndex + revisedCount; i += 1) {
-        MLSend(self->objects[i], "release");
-        self->objects[i] = MLZero;
+    if (self->isInteger) MLVectorIntegersScale(self->count, self->integers, MLIntegerFrom(factor));
+    else MLVectorDecimalsScale(self->count, self->decimals, MLDecimalFrom(factor));
+
+    return self;
+}
+
+static MLVariable MLNumberArrayDot(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable array, MLVariable options, ...) {
+    struct MLNumberArray* const other = array;
+
+    if (MLSend(array, "is-kind-of*", MLNumberArray) == MLNo || other->isInteger != self->isInteger || other->count != self->count) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't compute the dot product with X, X isn't a NumberArray of the same kind and count"));
     }
 
-    // Make room for new objects:
-    for (MLInteger j = self->count - 1; j >= MLIntegerIndex + revisedCount; j -= 1) {
-        self->objects[j + countOfObjects - revisedCount] = self->objects[j];
-        self->objects[j] = MLZero;
+    if (self->isInteger) return MLNumber(MLVectorIntegersDot(self->count, self->integers, other->integers));
+    return MLNumber(MLVectorDecimalsDot(self->count, self->decimals, other->decimals));
+}
+
+// Adds the numbers of another array of the same kind and count element-wise.
+static MLVariable MLNumberArrayAdd(struct MLNumberArray* self, MLVariable super, MLVariable command, MLVariable array, MLVariable options, ...) {
+    struct MLNumberArray* const other = array;
+
+    if (MLSend(self, "is-mutable") == MLNo) {
+        MLSend(self, "fail*", MLString("ImmutableException | Can't add numbers of X, object isn't mutable"));
     }
 
-    // Insert & retain new objects:
-    for (MLInteger k = 0; k < countOfObjects; k += 1) {
-       MLVariable const object = MLSend(objects, "at*", MLNumber(k));
-        self->objects[k + MLIntegerIndex] = MLSend(object, "retain");
+    if (MLSend(array, "is-kind-of*", MLNumberArray) == MLNo || other->isInteger != self->isInteger || other->count != self->count) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't add numbers of X, X isn't a NumberArray of the same kind and count"));
     }
 
-    // Update own properties:
-    self->count = self->count + countOfObjects - revisedCount;
+    if (self->isInteger) MLVectorIntegersAdd(self->count, self->integers, other->integers);
+    else MLVectorDecimalsAdd(self->count, self->decimals, other->decimals);
 
-    // Done.
     return self;
 }
 
@@ -898,24 +3921,31 @@ static MLVariable MLStringCreate(struct MLString* self, MLVariable super, MLVari
 }
 
 static MLVariable MLStringDestroy(struct MLString* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self->capacity < 0) {
-        struct MLEntry entry = {.key = (MLNatural)self, .value = 0, .extra = 0};
-        MLTablePut(&MLStringTable, &entry, MLStringHashFunction, MLStringEqualsFunction);
+    if (self->parent != MLZero) {
+        MLBufferDetach((struct MLBuffer*)self);
+        return MLSuper(self, "destroy");
+    }
+
+    // Interned strings may still be read by concurrent lookups:
+    if (self->capacity < 0 && self->length <= MLMaxKeyAndCommandLength) {
+        MLInternTableRemove(self);
+        MLEpochRetire(self, MLStringReclaim);
+        return MLNull;
     }
 
     free(self->characters);
+    MLRopeDestroy(self->rope);
     return MLSuper(self, "destroy");
 }
 
 static MLVariable MLStringAsString(struct MLString* self, MLVariable super, MLVariable command, MLVariable options, ...) {
     if (self == MLString) return MLStringClassName;
-   MLVariable const copy = MLSend(self, "copy");
-    return MLSend(copy, "autorelease");
+    MLVariable const copy = MLSend(self, "copy");
+    return MLSend(copy, "collect");
 }
 
 static MLVariable MLStringHash(struct MLString* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    MLNatural const hashFunction = MLDigest(self->length, self->characters);
-    return MLNumber((MLDecimal)hashFunction);
+    return MLHashNumber(MLStringHashValue(self));
 }
 
 static MLVariable MLStringEquals(struct MLString* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
@@ -927,41 +3957,215 @@ static MLVariable MLStringEquals(struct MLString* self, MLVariable super, MLVari
 
     if (string1->length != string2->length) return MLNo;
 
-    MLInteger const result = strncmp(string1->characters, string2->characters, string1->length);
+    MLInteger const result = strncmp(MLStringCharacters(string1), MLStringCharacters(string2), string1->length);
     return result == 0 ? MLYes : MLNo;
 }
 
 static MLVariable MLStringCompare(struct MLString* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
-    if (self == object) return MLYes;
+    if (self == object) return MLNumber(0);
     if (MLSend(object, "is-kind-of*", MLString) == MLNo) return MLNull;
 
     struct MLString* string1 = self;
     struct MLString* string2 = object;
 
-    MLInteger const result = strncmp(string1->characters, string2->characters, string1->length);
-    return MLNumber(result);
+    // Orders by bytes first, a string goes before the longer ones it begins:
+    int const result = memcmp(MLStringCharacters(string1), MLStringCharacters(string2), MLMin(string1->length, string2->length));
+    if (result != 0) return MLNumber(result < 0 ? -1 : +1);
+    return MLNumber((string1->length > string2->length) - (string1->length < string2->length));
 }
 
+// Like data, a copy of a mutable string is a view of all of it.
 static MLVariable MLStringCopy(struct MLString* self, MLVariable super, MLVariable command, MLVariable options, ...) {
     if (self->capacity < 0) return MLSend(self, "retain");
-    // TODO: make an immutable copy.
-    return MLNull;
+    return MLSend(MLSend(self, "at*count*", MLNumber(0), MLNumber(self->length)), "retain");
 }
 
 static MLVariable MLStringAtCount(struct MLString* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable options, ...) {
-    // TODO: implement.
-    return MLNull;
+    MLInteger const MLIntegerIndex = MLIntegerFrom(index);
+    MLInteger const MLIntegerCount = MLIntegerFrom(count);
+
+    // Validate arguments:
+    if (MLIntegerIndex < 0 || MLIntegerIndex > self->length) {
+        MLSend(self, "fail*", MLString("RangeException | Can't return X characters at index Y, index Y is out of range [0, B]"));
+    }
+
+    if (MLIntegerCount < 0) {
+        MLSend(self, "fail*", MLString("RangeException | Can't return X characters at index Y, count X out of range [0, ∞]"));
+    }
+
+    MLInteger const revisedCount = MLMin(self->length - MLIntegerIndex, MLIntegerCount);
+
+    // Short slices are made like any other string, so that they get interned:
+    bool const couldBeCommandOrKey = revisedCount <= MLMaxKeyAndCommandLength;
+    bool const shouldCopy = couldBeCommandOrKey || MLBufferShouldCopySlice((struct MLBuffer*)self, revisedCount);
+
+    if (self->rope == MLZero && shouldCopy) {
+        return MLCollectBlockAdd(MLStringMake(revisedCount, self->characters + MLIntegerIndex));
+    }
+
+    if (self->rope == MLZero) {
+        return MLCollectBlockAdd(MLBufferViewMake((struct MLBuffer*)self, &MLStringMeta, sizeof(struct MLString), MLIntegerIndex, revisedCount));
+    }
+
+    // Copy the range out of the rope without flattening it:
+    char* characters = malloc(revisedCount + 1);
+    MLRopeCopy(self->rope, MLIntegerIndex, revisedCount, characters);
+    MLVariable const string = MLStringMake(revisedCount, characters);
+    free(characters);
+
+    return MLCollectBlockAdd(string);
 }
 
 static MLVariable MLStringLength(struct MLString* self, MLVariable super, MLVariable command, MLVariable options, ...) {
     return MLNumber(self->length);
 }
 
+static MLVariable MLStringAsNumber(struct MLString* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLSend(MLNumber, "parse*", self);
+}
+
 static MLVariable MLStringReplaceAtCountWith(struct MLString* self, MLVariable super, MLVariable command, MLVariable index, MLVariable count, MLVariable string, MLVariable options, ...) {
-    // TODO: implement.
+    MLInteger const MLIntegerIndex = MLIntegerFrom(index);
+    MLInteger const MLIntegerCount = MLIntegerFrom(count);
+
+    // Make sure string is mutable:
+    if (MLSend(self, "is-mutable") == MLNo) {
+        MLSend(self, "fail*", MLString("ImmutableException | Can't replace X characters at index Y with Z, object isn't mutable"));
+    }
+
+    // Validate arguments:
+    if (MLIntegerIndex < 0 || MLIntegerIndex > self->length) {
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X characters at index Y with Z, index Y is out of range [0, B]"));
+    }
+
+    if (MLIntegerCount < 0) {
+        MLSend(self, "fail*", MLString("RangeException | Can't replace X characters at index Y with Z, count Y out of range [0, ∞]"));
+    }
+
+    if (MLSend(string, "is-kind-of*", MLString) == MLNo) {
+        MLSend(self, "fail*", MLString("InvalidArgumentException | Can't replace X characters at index Y with Z, Z isn't a String"));
+    }
+
+    // Views of the current characters must not see them change:
+    MLBufferMaterializeViews((struct MLBuffer*)self);
+
+    // Gather information:
+    struct MLString* const replacement = string;
+    MLInteger const revisedCount = MLMin(self->length - MLIntegerIndex, MLIntegerCount);
+    MLInteger const requiredCapacity = self->length + replacement->length - revisedCount;
+
+    // Replacing a range with the whole string itself needs a copy of the original:
+    char* const source = replacement == self ? memcpy(malloc(self->length + 1), MLStringCharacters(self), self->length) : MLStringCharacters(replacement);
+
+    // Switch to a rope once the string gets large, so that edits stay cheap:
+    if (self->rope == MLZero && requiredCapacity >= MLStringRopeThreshold) {
+        self->rope = MLRopeMake(self->length, self->characters);
+        free(self->characters);
+        self->characters = MLZero;
+        self->capacity = 0;
+    }
+
+    if (self->rope != MLZero) {
+        struct MLRope* head = MLZero;
+        struct MLRope* middle = MLZero;
+        struct MLRope* tail = MLZero;
+
+        MLRopeSplit(self->rope, MLIntegerIndex, &head, &tail);
+        MLRopeSplit(tail, revisedCount, &middle, &tail);
+        MLRopeDestroy(middle);
+
+        self->rope = MLRopeConcatenate(MLRopeConcatenate(head, MLRopeMake(replacement->length, source)), tail);
+    }
+
+    else {
+        // Ensure enough capacity, then make room for and copy in the new characters:
+        MLStringEnsureCapacity(self, requiredCapacity);
+
+        char* const characters = self->characters;
+        memmove(characters + MLIntegerIndex + replacement->length, characters + MLIntegerIndex + revisedCount, self->length - MLIntegerIndex - revisedCount);
+        memmove(characters + MLIntegerIndex, source, replacement->length);
+        characters[requiredCapacity] = '\0';
+    }
+
+    if (replacement == self) free(source);
+
+    // Update own properties, the cached hash is stale now:
+    self->length = requiredCapacity;
+    self->hash = 0;
+
+    // Done.
+    return self;
+}
+
+// ----------------------------------------------- String Builder Methods ------
+
+static MLVariable MLStringBuilderCreate(struct MLStringBuilder* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLVariable capacity = MLOption("capacity", MLNumber(1));
+
+    self = MLSuper(self, "create", MLString("mutable"), MLYes);
+    self->capacity = MLIntegerFrom(capacity);
+    self->capacity = MLMax(self->capacity, MLStringBuilderDefaultCapacity);
+    self->capacity = MLRoundUpToPowerOfTwo(self->capacity + 1) - 1;
+    self->length = 0;
+    self->characters = calloc(self->capacity + 1, sizeof(char));
+
+    return self;
+}
+
+static MLVariable MLStringBuilderDestroy(struct MLStringBuilder* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    free(self->characters);
+    return MLSuper(self, "destroy");
+}
+
+static MLVariable MLStringBuilderAsString(struct MLStringBuilder* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLStringBuilder) return MLStringBuilderClassName;
+    return MLCollectBlockAdd(MLStringMake(self->length, self->characters));
+}
+
+static MLVariable MLStringBuilderLength(struct MLStringBuilder* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLNumber(self->length);
+}
+
+// Appends strings and the bytes of data objects as they are, numbers are
+// formatted in place, anything else is appended as its `as-string`.
+static MLVariable MLStringBuilderAppend(struct MLStringBuilder* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    if (MLSend(object, "is-kind-of*", MLNumber) == MLYes) {
+        MLStringBuilderEnsureCapacity(self, self->length + MLNumberFormatMaximumLength);
+        self->length += MLNumberFormat(MLDecimalFrom(object), self->characters + self->length);
+        return self;
+    }
+
+    if (MLSend(object, "is-kind-of*", MLString) == MLNo && MLSend(object, "is-kind-of*", MLData) == MLNo) {
+        object = MLSend(object, "as-string");
+    }
+
+    // Data and strings share the layout of MLBuffer:
+    struct MLBuffer* buffer = object;
+    char const* bytes = buffer->meta == &MLStringMeta ? MLStringCharacters(object) : buffer->bytes;
+    MLStringBuilderAppendCharacters(self, buffer->count, bytes);
+
     return self;
 }
 
+// Short strings are interned, so the builder keeps its buffer for reuse and
+// the characters are copied; longer ones take over the buffer as it is.
+static MLVariable MLStringBuilderFreeze(struct MLStringBuilder* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self->length <= MLMaxKeyAndCommandLength) {
+        MLVariable const string = MLStringMake(self->length, self->characters);
+        self->length = 0;
+        self->characters[0] = '\0';
+        return MLCollectBlockAdd(string);
+    }
+
+    struct MLString* const string = MLStringTake(self->length, self->characters);
+
+    self->capacity = MLStringBuilderDefaultCapacity;
+    self->length = 0;
+    self->characters = calloc(self->capacity + 1, sizeof(char));
+
+    return MLCollectBlockAdd(string);
+}
+
 // --------------------------------------------------- Dictionary Methods ------
 
 static MLVariable MLDictionaryCreate(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
@@ -982,19 +4186,28 @@ static MLVariable MLDictionaryCreate(struct MLDictionary* self, MLVariable super
 }
 
 static MLVariable MLDictionaryDestroy(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    for (int i = 0; i < self->count; i += 2) {
-        MLVariable key = self->entries[i];
-        MLVariable value = self->entries[i + 1];
+    if (!MLShareLeave(&self->shares)) return MLSuper(self, "destroy");
+
+    MLVariable* const entriesList[] = {self->entries, self->entriesOld};
+    MLNatural const masks[] = {self->mask, self->maskOld};
+
+    for (int list = 0; list < 2; list += 1) {
+        MLVariable* const entries = entriesList[list];
+        if (entries == MLZero) continue;
+
+        for (MLNatural index = 0; index <= masks[list]; index += 1) {
+            MLVariable key = entries[index * 2];
+            MLVariable value = entries[index * 2 + 1];
 
-        if (key != MLZero && key != MLMore) {
-            MLSend(key, "release");
-            MLSend(value, "release");
+            if (key != MLZero && key != MLMore) {
+                MLSend(key, "release");
+                MLSend(value, "release");
+            }
         }
 
-        self->entries[i] = MLZero;
-        self->entries[i + 1] = MLZero;
+        free(entries);
     }
-    free(self->entries);
+
     return MLSuper(self, "destroy");
 }
 
@@ -1005,8 +4218,7 @@ static MLVariable MLDictionaryAsString(struct MLDictionary* self, MLVariable sup
 }
 
 static MLVariable MLDictionaryHash(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    // TODO: implement.
-    return MLNull;
+    return MLHashNumber(MLDictionaryHashValue(self));
 }
 
 static MLVariable MLDictionaryEquals(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
@@ -1018,126 +4230,290 @@ static MLVariable MLDictionaryEquals(struct MLDictionary* self, MLVariable super
 
     if (dictionary1->count != dictionary2->count) return MLNo;
 
-    for (int index = 0; index < dictionary1->count; index += 1) {
-        MLVariable key = dictionary1->entries[index * 2];
-        if (key != MLZero) {
-            MLVariable value1 = dictionary1->entries[index * 2 + 1];
+    MLNatural const hash1 = __atomic_load_n(&dictionary1->hash, __ATOMIC_RELAXED);
+    MLNatural const hash2 = __atomic_load_n(&dictionary2->hash, __ATOMIC_RELAXED);
+    if (hash1 != 0 && hash2 != 0 && hash1 != hash2) return MLNo;
+
+    MLVariable* const entriesList[] = {dictionary1->entries, dictionary1->entriesOld};
+    MLNatural const masks[] = {dictionary1->mask, dictionary1->maskOld};
+
+    for (int list = 0; list < 2; list += 1) {
+        MLVariable* const entries = entriesList[list];
+        if (entries == MLZero) continue;
+
+        for (MLNatural index = 0; index <= masks[list]; index += 1) {
+            MLVariable key = entries[index * 2];
+            if (key == MLZero || key == MLMore) continue;
+
+            MLVariable value1 = entries[index * 2 + 1];
             MLVariable value2 = MLSend(dictionary2, "get*", key);
-            if (MLSend(value1, "equals*", value2) == MLNo) return MLNo;
+            if (value1 != value2 && MLSend(value1, "equals*", value2) == MLNo) return MLNo;
         }
     }
 
     return MLYes;
 }
 
+// Copies share the entries until either dictionary changes, an unfinished
+// migration is finished first so there's only one table to share.
 static MLVariable MLDictionaryCopy(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
-    if (self->capacity < 0) return MLSend(self, "retain");
-    // TODO: make an immutable copy.
-    return MLNull;
+    MLVariable mutable = MLOption("mutable", MLNo);
+    bool const isMutable = self->retainCountAndFlags & MLMutableFlag;
+    if (!isMutable && mutable == MLNo) return MLSend(self, "retain");
+
+    MLDictionaryMigrate(self, MLNaturalMax);
+
+    struct MLDictionary* copy = calloc(1, sizeof(struct MLDictionary));
+    copy->meta = self->meta;
+    copy->retainCountAndFlags = MLRetainCountOne | (mutable == MLYes ? MLMutableFlag : 0);
+    copy->capacity = self->capacity;
+    copy->count = self->count;
+    copy->hash = self->hash;
+    copy->tombstones = self->tombstones;
+    copy->mask = self->mask;
+    copy->entries = self->entries;
+    copy->shares = MLShareJoin(&self->shares);
+
+    return copy;
 }
 
 static MLVariable MLDictionaryGet(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable options, ...) {
-    MLNatural const mask = self->mask;
+    if (self->count == 0) return MLNull;
+
     MLNatural const hash = MLNaturalFrom(MLSend(key, "hash"));
-    MLNatural index = hash & mask;
+    MLInteger index = MLDictionaryFind(self->entries, self->mask, hash, key);
+    if (index >= 0) return self->entries[index * 2 + 1];
 
-    for (MLNatural i = 0; i <= mask; i += 1) {
-        MLInteger const indexOfKey = index * 2;
-        MLInteger const indexOfValue = indexOfKey + 1;
-       MLVariable const keyAtIndex = self->entries[indexOfKey];
-       MLVariable const valueAtIndex = self->entries[indexOfValue];
+    if (self->entriesOld == MLZero) return MLNull;
+
+    index = MLDictionaryFind(self->entriesOld, self->maskOld, hash, key);
+    if (index >= 0) return self->entriesOld[index * 2 + 1];
+
+    return MLNull;
+}
+
+static MLVariable MLDictionarySetTo(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable value, MLVariable options, ...) {
+    MLDictionaryDetach(self);
+    self->hash = 0;
+    self->mutations += 1;
+    MLDictionaryMigrate(self, MLDictionaryMigrationSteps);
+
+    MLNatural const hash = MLNaturalFrom(MLSend(key, "hash"));
+    MLVariable* entries = self->entries;
+    MLInteger index = MLDictionaryFind(entries, self->mask, hash, key);
+
+    if (index < 0 && self->entriesOld != MLZero) {
+        entries = self->entriesOld;
+        index = MLDictionaryFind(entries, self->maskOld, hash, key);
+    }
+
+    MLSend(key, "retain");
+    MLSend(value, "retain");
+
+    if (index >= 0) {
+        MLSend(entries[index * 2], "release");
+        MLSend(entries[index * 2 + 1], "release");
+        entries[index * 2] = key;
+        entries[index * 2 + 1] = value;
+        return self;
+    }
+
+    MLDictionaryEnsureCapacity(self, self->count + 1);
+    MLDictionaryInsert(self, hash, key, value);
+    self->count += 1;
+
+    return self;
+}
+
+static MLVariable MLDictionaryRemove(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable options, ...) {
+    if (self->count == 0) return self;
+
+    MLDictionaryDetach(self);
+    self->hash = 0;
+    self->mutations += 1;
+    MLDictionaryMigrate(self, MLDictionaryMigrationSteps);
+
+    MLNatural const hash = MLNaturalFrom(MLSend(key, "hash"));
+    MLVariable* entries = self->entries;
+    MLInteger index = MLDictionaryFind(entries, self->mask, hash, key);
+    bool const isInOldEntries = index < 0 && self->entriesOld != MLZero;
+
+    if (isInOldEntries) {
+        entries = self->entriesOld;
+        index = MLDictionaryFind(entries, self->maskOld, hash, key);
+    }
+
+    if (index < 0) return self;
+
+    MLSend(entries[index * 2], "release");
+    MLSend(entries[index * 2 + 1], "release");
+
+    entries[index * 2] = MLMore;
+    entries[index * 2 + 1] = MLZero;
+
+    self->count -= 1;
+    if (!isInOldEntries) self->tombstones += 1;
+
+    // Contract only well below the load right after contracting (hysteresis):
+    bool const isNearlyEmpty = self->count < (self->capacity >> 3);
+    bool const canContract = self->entriesOld == MLZero && self->capacity > MLDictionaryDefaultCapacity;
+    if (isNearlyEmpty && canContract) MLDictionaryResize(self, self->capacity >> 1);
+
+    return self;
+}
+
+// Enumerates the keys, first those in the current entries, then those still
+// waiting to be migrated out of the old ones. The `state` is the next slot to
+// look at, counting the slots of both entries one after the other.
+static MLVariable MLDictionaryEnumerate(struct MLDictionary* self, MLVariable super, MLVariable command, struct MLEnumeration* enumeration, MLVariable options, ...) {
+    if (enumeration->state == 0) {
+        enumeration->mutations = &self->mutations;
+        enumeration->mutationsSeen = self->mutations;
+    }
+
+    MLNatural const capacity = self->mask + 1;
+    MLNatural const capacityOld = self->entriesOld != MLZero ? self->maskOld + 1 : 0;
+    MLNatural slot = enumeration->state;
+    MLInteger count = 0;
+
+    for (; slot < capacity + capacityOld && count < MLEnumerationBufferCount; slot += 1) {
+        MLVariable const key = slot < capacity ? self->entries[slot * 2] : self->entriesOld[(slot - capacity) * 2];
+        if (key != MLZero && key != MLMore) enumeration->buffer[count++] = key;
+    }
+
+    enumeration->objects = enumeration->buffer;
+    enumeration->count = count;
+    enumeration->state = slot;
+
+    return MLBoolean(count > 0);
+}
+
+static MLVariable MLDictionaryCount(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLNumber(self->count);
+}
+
+// ---------------------------------------- Persistent Dictionary Methods ------
+
+static MLVariable MLPersistentDictionaryCreate(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLVariable mutable = MLOption("mutable", MLNo);
+
+    self = MLSuper(self, "create", MLString("mutable"), mutable);
+    self->count = 0;
+    self->root = MLTrieNodeMake(0);
+
+    return self;
+}
+
+static MLVariable MLPersistentDictionaryDestroy(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    MLTrieNodeRelease(self->root);
+    return MLSuper(self, "destroy");
+}
 
-        if (keyAtIndex == MLMore) {
-            continue;
-        }
+static MLVariable MLPersistentDictionaryAsString(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if (self == MLPersistentDictionary) return MLPersistentDictionaryClassName;
 
-        if (keyAtIndex == MLZero) {
-            return MLNull;
-        }
+    struct MLStringBuilder* const builder = MLSend(MLStringBuilder, "create");
+    bool isFirst = true;
 
-        if (MLSend(keyAtIndex, "equals*", key) == MLYes) {
-            return valueAtIndex;
-        }
+    MLStringBuilderAppendCharacters(builder, 1, "{");
+    MLTrieAppendEntries(self->root, builder, &isFirst);
+    MLStringBuilderAppendCharacters(builder, 1, "}");
 
-        index = (index + 1) & mask;
-    }
+    return MLSend(builder, "freeze");
+}
 
-    return MLNull;
+// Doesn't depend on the order of the entries, consistently with equals*.
+static MLVariable MLPersistentDictionaryHash(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    return MLHashNumber((MLDigestSecret[0] ^ (MLNatural)self->count) + MLTrieHashValue(self->root));
 }
 
-static MLVariable MLDictionarySetTo(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable value, MLVariable options, ...) {
-    MLDictionaryEnsureCapacity(self, self->count + 1);
+static MLVariable MLPersistentDictionaryEquals(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable object, MLVariable options, ...) {
+    if (self == object) return MLYes;
+    if (MLSend(object, "is-kind-of*", MLPersistentDictionary) == MLNo) return MLNo;
 
-    MLNatural const mask = self->mask;
-    MLNatural const hash = MLNaturalFrom(MLSend(key, "hash"));
-    MLNatural index = hash & mask;
+    struct MLPersistentDictionary* dictionary1 = self;
+    struct MLPersistentDictionary* dictionary2 = object;
 
-    for (MLNatural i = 0; i <= mask; i += 1) {
-        MLInteger const indexOfKey = index * 2;
-        MLInteger const indexOfValue = indexOfKey + 1;
-       MLVariable const keyAtIndex = self->entries[indexOfKey];
+    if (dictionary1->count != dictionary2->count) return MLNo;
+    if (dictionary1->root == dictionary2->root) return MLYes;
 
-        if (keyAtIndex == MLZero || keyAtIndex == MLMore) {
-            MLSend(key, "retain");
-            MLSend(value, "retain");
-            self->entries[indexOfKey] = key;
-            self->entries[indexOfValue] = value;
-            self->count += 1;
-            break;
-        }
+    return MLBoolean(MLTrieContainsAll(dictionary1->root, 0, dictionary2));
+}
 
-        if (MLSend(keyAtIndex, "equals*", key) == MLYes) {
-            MLSend(key, "retain");
-            MLSend(value, "retain");
-            MLSend(self->entries[indexOfKey], "release");
-            MLSend(self->entries[indexOfValue], "release");
-            self->entries[indexOfKey] = key;
-            self->entries[indexOfValue] = value;
-            break;
-        }
+static MLVariable MLPersistentDictionaryCopy(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    if ((self->retainCountAndFlags & MLMutableFlag) == 0) return MLSend(self, "retain");
 
-        index = (index + 1) & mask;
-    }
+    // Freezing a transient shares the whole trie, later edits to the
+    // transient copy the paths they touch:
+    struct MLPersistentDictionary* copy = calloc(1, sizeof(struct MLPersistentDictionary));
+    copy->meta = self->meta;
+    copy->retainCountAndFlags = MLRetainCountOne;
+    copy->count = self->count;
+    copy->root = self->root;
+    __atomic_add_fetch(&copy->root->retainCount, 1, __ATOMIC_RELAXED);
 
-    return self;
+    return copy;
 }
 
-static MLVariable MLDictionaryRemove(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable options, ...) {
-    MLNatural const mask = self->mask;
-    MLNatural const hash = MLNaturalFrom(MLSend(key, "hash"));
-    MLNatural index = hash & mask;
+static MLVariable MLPersistentDictionaryGet(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable options, ...) {
+    if (self->count == 0) return MLNull;
+    return MLTrieGet(self->root, 0, MLTrieHash(key), key);
+}
 
-    for (MLNatural i = 0; i <= mask; i += 1) {
-        MLInteger const indexOfKey = index * 2;
-        MLInteger const indexOfValue = indexOfKey + 1;
-       MLVariable const keyAtIndex = self->entries[indexOfKey];
-       MLVariable const valueAtIndex = self->entries[indexOfValue];
+static MLVariable MLPersistentDictionarySetTo(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable value, MLVariable options, ...) {
+    bool const isMutable = self->retainCountAndFlags & MLMutableFlag;
+    bool added = false;
 
-        if (keyAtIndex == MLMore) {
-            continue;
-        }
+    struct MLTrieNode* const root = MLTrieSet(self->root, isMutable, 0, MLTrieHash(key), key, value, &added);
+    MLInteger const count = self->count + (added ? 1 : 0);
 
-        if (keyAtIndex == MLZero) {
-            return self;
-        }
+    if (isMutable) {
+        if (root != self->root) MLTrieNodeRelease(self->root);
+        self->root = root;
+        self->count = count;
+        return self;
+    }
 
-        if (MLSend(keyAtIndex, "equals*", key) == MLYes) {
-            MLSend(keyAtIndex, "release");
-            MLSend(valueAtIndex, "release");
+    if (root == self->root) return self;
 
-            self->entries[indexOfKey] = MLMore;
-            self->entries[indexOfValue] = MLZero;
+    struct MLPersistentDictionary* version = calloc(1, sizeof(struct MLPersistentDictionary));
+    version->meta = self->meta;
+    version->retainCountAndFlags = MLRetainCountOne;
+    version->count = count;
+    version->root = root;
 
-            return self;
-        }
+    return MLCollectBlockAdd(version);
+}
 
-        index = (index + 1) & mask;
+static MLVariable MLPersistentDictionaryRemove(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable key, MLVariable options, ...) {
+    if (self->count == 0) return self;
+
+    bool const isMutable = self->retainCountAndFlags & MLMutableFlag;
+    bool removed = false;
+
+    struct MLTrieNode* root = MLTrieRemove(self->root, isMutable, 0, MLTrieHash(key), key, &removed);
+    MLInteger const count = self->count - 1;
+
+    if (!removed) return self;
+    if (root == MLZero) root = MLTrieNodeMake(0);
+
+    if (isMutable) {
+        if (root != self->root) MLTrieNodeRelease(self->root);
+        self->root = root;
+        self->count = count;
+        return self;
     }
 
-    return self;
+    struct MLPersistentDictionary* version = calloc(1, sizeof(struct MLPersistentDictionary));
+    version->meta = self->meta;
+    version->retainCountAndFlags = MLRetainCountOne;
+    version->count = count;
+    version->root = root;
+
+    return MLCollectBlockAdd(version);
 }
 
-static MLVariable MLDictionaryCount(struct MLDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
+static MLVariable MLPersistentDictionaryCount(struct MLPersistentDictionary* self, MLVariable super, MLVariable command, MLVariable options, ...) {
     return MLNumber(self->count);
 }
 
@@ -1276,11 +4652,7 @@ MLVariable MLArrayMake(long count, ...) {
     va_list arguments;
     va_start(arguments, count);
     for (int i = 0; i < count; i += 1) {
-        MLVariable object = va_arg(arguments, MLVariable);
-        array->objects[i] = object;
-
-        // TODO: retain here instaed of the extra pass below.
-
+        array->objects[i] = va_arg(arguments, MLVariable);
     }
 
     // Make mutable if needed:
@@ -1293,9 +4665,7 @@ MLVariable MLArrayMake(long count, ...) {
     }
 
     // Retain objects:
-    for (int i = 0; i < array->count; i += 1) {
-        MLSend(array->objects[i], "retain");
-    }
+    MLRetainMany(array->count, array->objects);
 
     // Done:
     va_end(arguments);
@@ -1305,20 +4675,15 @@ MLVariable MLArrayMake(long count, ...) {
 MLVariable MLStringMake(long length, const char* characters) {
     MLAssert(length >= 0, "When making a string, length must be >= 0");
 
-    MLNatural const hash = MLDigest(length, characters);
+    // Only strings that get interned need their hash right away:
     bool const couldBeCommandOrKey = length <= MLMaxKeyAndCommandLength;
+    MLNatural const hash = couldBeCommandOrKey ? MLDigest(length, characters) : 0;
 
+    // Can't send 'retain' here becuase MLStringMake() is used by the message
+    // sending mechanism, the intern table retains found strings directly.
     if (couldBeCommandOrKey) {
-        struct MLString proxy = {.meta = &MLStringMeta, .retainCountAndFlags = MLRetainCountMax, .capacity = -1, .length = length, .hash = hash, .characters = (char*)characters};
-        struct MLEntry entry = {.key = (MLNatural)&proxy, .value = 0, .extra = 0};
-
-        MLTableGet(&MLStringTable, &entry, MLStringHashFunction, MLStringEqualsFunction);
-        struct MLString* string = (struct MLString*)entry.value;
-
-        // Can't use retain() here or send 'retain' message becuase MLStringMake() is used
-        // by the message sending mechanism. Calling the method implementation directly
-        // is safe here, because we know for sure that we are dealing with a string object.
-        if (string != MLZero) return MLObjectRetain((struct MLObject *)string, MLObject, NULL, NULL);
+        struct MLString* string = MLInternTableGet(length, characters, hash);
+        if (string != MLZero) return string;
     }
 
     struct MLString* string = calloc(1, sizeof(struct MLString));
@@ -1328,16 +4693,37 @@ MLVariable MLStringMake(long length, const char* characters) {
     string->length = length;
     string->hash = hash;
     string->characters = calloc(length + 1, sizeof(char));
-    strncpy(string->characters, characters, length);
+    memcpy(string->characters, characters, length);
 
     if (couldBeCommandOrKey) {
-        struct MLEntry entry = {.key = (MLNatural)string, .value = (MLNatural)string, .extra = 0};
-        MLTablePut(&MLStringTable, &entry, MLStringHashFunction, MLStringEqualsFunction);
+        struct MLString* const interned = MLInternTableAdd(string);
+        if (interned != string) MLStringReclaim(string);
+        return interned;
     }
 
     return string;
 }
 
+// Turns the constant's storage into an eternal string and interns it, unless
+// an equal string is interned already. Threads that lose the race to claim
+// the storage get the interned string through MLStringMake() instead.
+MLVariable MLStringConstantResolve(struct MLStringConstant* constant, const char* characters) {
+    MLNatural unclaimed = 0;
+    bool const isClaimed = __atomic_compare_exchange_n(&constant->retainCountAndFlags, &unclaimed, MLRetainCountMax, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+    if (!isClaimed) return MLCollectBlockAdd(MLStringMake(constant->length, characters));
+
+    struct MLString* string = (struct MLString*)constant;
+    string->meta = &MLStringMeta;
+    string->capacity = -1;
+    string->hash = MLDigest(string->length, characters);
+    string->characters = (char*)characters;
+
+    // Long strings are never keys or commands, they aren't interned:
+    struct MLString* const resolved = string->length <= MLMaxKeyAndCommandLength ? MLInternTableAdd(string) : string;
+    __atomic_store_n(&constant->resolved, resolved, __ATOMIC_RELEASE);
+    return resolved;
+}
+
 MLVariable MLDictionaryMake(long count, ...) {
     MLAssert(count >= 0, "When making a dictionary, count must be >= 0");
 
@@ -1368,6 +4754,35 @@ MLVariable MLDictionaryMake(long count, ...) {
    return dictionary;
 }
 
+MLVariable MLPersistentDictionaryMake(long count, ...) {
+    MLAssert(count >= 0, "When making a persistent dictionary, count must be >= 0");
+
+    struct MLPersistentDictionary* dictionary = calloc(1, sizeof(struct MLPersistentDictionary));
+    dictionary->meta = &MLPersistentDictionaryMeta;
+    dictionary->retainCountAndFlags = MLRetainCountOne | MLMutableFlag;
+    dictionary->count = 0;
+    dictionary->root = MLTrieNodeMake(0);
+
+    va_list arguments;
+    va_start(arguments, count);
+
+    // Build up as a transient, editing the trie in place:
+    for (int i = 0; i < count - 1; i += 2) {
+        MLVariable key = va_arg(arguments, MLVariable);
+        MLVariable value = va_arg(arguments, MLVariable);
+        MLPersistentDictionarySetTo(dictionary, NULL, MLNull, key, value, MLZero);
+    }
+
+    // Keep it transient only if requested:
+    if (va_arg(arguments, MLVariable) != MLMore) {
+        dictionary->retainCountAndFlags &= ~MLMutableFlag;
+    }
+
+    // Done:
+    va_end(arguments);
+    return dictionary;
+}
+
 // ------------------------------------------------- Conversion Functions ------
 
 MLInteger MLIntegerFrom(MLVariable number) {
@@ -1395,21 +4810,17 @@ void* MLCollectBlockPush() {
 }
 
 void* MLCollectBlockPop(void* collectBlock) {
-    // TODO: remove all child collect blocks from the stack
-    // and release its objects if landed here through exception.
     MLAssert(collectBlock == MLCollectBlockTop, "When popping a collect block, the top-most one must be the same as the one passed in");
     struct MLCollectBlock* collectBlockToPop = collectBlock;
     MLCollectBlockTop = collectBlockToPop->previousCollectBlock;
-    for (int index = 0; index < collectBlockToPop->count; index += 1) {
-        MLSend(collectBlockToPop->objects[index], "release");
-    }
+    MLReleaseMany(collectBlockToPop->count, collectBlockToPop->objects);
     free(collectBlockToPop->objects);
     free(collectBlockToPop);
     return MLZero;
 }
 
 MLVariable MLCollectBlockAdd(MLVariable object) {
-    if (object(object).retainCountAndFlags >= MLRetainCountMax) return object;
+    if (__atomic_load_n(&object(object).retainCountAndFlags, __ATOMIC_RELAXED) >= MLRetainCountMax) return object;
     if (MLCollectBlockTop == MLZero) {
         fprintf(stderr, "[WARNING] No collect block found, leaking ...\n");
         return object;
@@ -1433,32 +4844,48 @@ MLVariable MLCollectBlockAdd(MLVariable object) {
     return object;
 }
 
+// ------------------------------------------------ Enumeration Functions ------
+
+// Returns the next object of the enumerated collection, fetching a new batch
+// once the current one is used up, or MLZero once there are no more objects.
+MLVariable MLEnumerationNext(struct MLEnumeration* enumeration) {
+    if (enumeration->mutations != MLZero && *enumeration->mutations != enumeration->mutationsSeen) {
+        MLSend(enumeration->collection, "fail*", MLString("MutationException | Collection X was mutated while being enumerated"));
+    }
+
+    if (enumeration->index < enumeration->count) {
+        return enumeration->objects[enumeration->index++];
+    }
+
+    MLSend(enumeration->collection, "enumerate*", enumeration);
+    enumeration->index = 0;
+    if (enumeration->count == 0) return MLZero;
+
+    return enumeration->objects[enumeration->index++];
+}
+
 // --------------------------------------- Perform-Handle-Block Functions ------
 
-void* MLPerformHandleBlockPush() {
-    struct MLPerformHandleBlock* performHandleBlock = calloc(1, sizeof(struct MLPerformHandleBlock));
+// Blocks are frames on the stack of whoever uses MLPerform, pushing and
+// popping them only links and unlinks them.
+
+struct MLPerformHandleBlock* MLPerformHandleBlockPush(struct MLPerformHandleBlock* performHandleBlock) {
     performHandleBlock->previousPerformHandleBlock = MLPerformHandleBlockTop;
+    performHandleBlock->collectBlock = MLCollectBlockTop;
     performHandleBlock->exception = MLNull;
     performHandleBlock->raised = false;
     MLPerformHandleBlockTop = performHandleBlock;
     return performHandleBlock;
 }
 
-void* MLPerformHandleBlockPop(void* performHandleBlock) {
+struct MLPerformHandleBlock* MLPerformHandleBlockPop(struct MLPerformHandleBlock* performHandleBlock) {
     MLAssert(performHandleBlock == MLPerformHandleBlockTop, "When popping a perform-handle block, the top-most one must be the same as the one passed in");
-    struct MLPerformHandleBlock* performHandleBlockToPop = performHandleBlock;
-    MLPerformHandleBlockTop = performHandleBlockToPop->previousPerformHandleBlock;
-    MLSend(performHandleBlockToPop->exception, "release");
-    free(performHandleBlockToPop);
+    MLPerformHandleBlockTop = performHandleBlock->previousPerformHandleBlock;
+    if (performHandleBlock->raised) MLSend(performHandleBlock->exception, "release");
     return MLZero;
 }
 
-void* MLPerformHandleBlockPerform(void* performHandleBlock) {
-    MLAssert(performHandleBlock == MLPerformHandleBlockTop, "When beginning a perform block, the top-most perform-handle block must be the same as the one passed in");
-    return MLPerformHandleBlockTop->destination;
-}
-
-MLVariable MLPerformHandleBlockHandle(void* performHandleBlock) {
+MLVariable MLPerformHandleBlockHandle(struct MLPerformHandleBlock* performHandleBlock) {
     MLAssert(performHandleBlock == MLPerformHandleBlockTop, "When beginning a handle block, the top-most perform-handle block must be the same as the one passed in");
     return MLPerformHandleBlockTop->exception;
 }
@@ -1488,7 +4915,7 @@ void* MLLookup(MLVariable object, MLVariable command, MLVariable* super) {
 
     // Look up in own methods:
     MLAssert(string(command).length <= MLMaxKeyAndCommandLength, "When looking up a method for a given command, the length of the command must be <= MLMaxKeyAndCommandLength");
-    struct MLEntry entry = {.key = (MLNatural)command, .value = 0, .extra = 0};
+    struct MLEntry entry = {.key = (MLNatural)command, .value = 0};
     MLTableGet(methods, &entry, MLZero, MLZero);
 
     code = (void *)entry.value;
@@ -1523,19 +4950,24 @@ void MLRaise(MLVariable exception) {
 
     if (performHandleBlock == MLZero) {
         MLVariable description = MLSend(exception, "as-string");
-        fprintf(stderr, "[ERROR] %s\n", string(description).characters);
+        fprintf(stderr, "[ERROR] %.*s\n", (int)string(description).length, MLStringCharacters(description));
+        abort();
     }
 
+    // Jumping skips the pops of the collect blocks entered since the perform
+    // block, so pop them here. The exception is retained, so it survives:
+    while (MLCollectBlockTop != performHandleBlock->collectBlock) MLCollectBlockPop(MLCollectBlockTop);
+
     performHandleBlock->exception = exception;
     performHandleBlock->raised = true;
 
-    longjmp(performHandleBlock->destination, 1);
+    siglongjmp(performHandleBlock->destination, 1);
 }
 
 void MLLog(MLVariable object) {
     MLCollect {
         MLVariable description = MLSend(object, "as-string");
-        fprintf(stderr, "%s\n", string(description).characters);
+        fprintf(stderr, "%.*s\n", (int)string(description).length, MLStringCharacters(description));
     }
 }
 
@@ -1543,7 +4975,17 @@ void MLLog(MLVariable object) {
 
 static void MLBootstrap Metal() {
     MLCollect {
-        MLTableCreate(&MLStringTable, MLStringTableBlockDefaultCapacity);
+        pthread_key_create(&MLEpochRecordKey, MLEpochThreadExit);
+        MLCodecInitialize();
+
+        for (MLNatural index = 0; index < MLInternShardsCount; index += 1) {
+            pthread_mutex_init(&MLInternTable[index].lock, NULL);
+            MLInternTable[index].buckets = MLInternBucketsMake(MLStringTableBlockDefaultCapacity / MLInternShardsCount);
+        }
+
+        for (int byte = 0; byte < 256; byte += 1) {
+            MLByteNumbers[byte] = (struct MLNumber){.meta = &MLNumberMeta, .retainCountAndFlags = MLRetainCountMax, .number = byte};
+        }
 
         MLObjectMeta.owner = &MLObjectState;
         MLBooleanMeta.owner = &MLBooleanState;
@@ -1551,9 +4993,13 @@ static void MLBootstrap Metal() {
         MLBlockMeta.owner = &MLBlockState;
         MLDataMeta.owner = &MLDataState;
         MLArrayMeta.owner = &MLArrayState;
+        MLNumberArrayMeta.owner = &MLNumberArrayState;
         MLStringMeta.owner = &MLStringState;
+        MLStringBuilderMeta.owner = &MLStringBuilderState;
         MLDictionaryMeta.owner = &MLDictionaryState;
+        MLPersistentDictionaryMeta.owner = &MLPersistentDictionaryState;
         MLExceptionMeta.owner = &MLExceptionState;
+        MLFutureMeta.owner = &MLFutureState;
         MLNullMeta.owner = &MLNullState;
 
         MLObjectMeta.parent = MLNull;
@@ -1562,9 +5008,13 @@ static void MLBootstrap Metal() {
         MLBlockMeta.parent = &MLObjectState;
         MLDataMeta.parent = &MLObjectState;
         MLArrayMeta.parent = &MLObjectState;
+        MLNumberArrayMeta.parent = &MLObjectState;
         MLStringMeta.parent = &MLObjectState;
+        MLStringBuilderMeta.parent = &MLObjectState;
         MLDictionaryMeta.parent = &MLObjectState;
+        MLPersistentDictionaryMeta.parent = &MLObjectState;
         MLExceptionMeta.parent = &MLExceptionState;
+        MLFutureMeta.parent = &MLObjectState;
         MLNullMeta.parent = &MLObjectState;
 
         MLObjectMeta.size = sizeof(struct MLObject);
@@ -1573,9 +5023,13 @@ static void MLBootstrap Metal() {
         MLBlockMeta.size = sizeof(struct MLBlock);
         MLDataMeta.size = sizeof(struct MLData);
         MLArrayMeta.size = sizeof(struct MLArray);
+        MLNumberArrayMeta.size = sizeof(struct MLNumberArray);
         MLStringMeta.size = sizeof(struct MLString);
+        MLStringBuilderMeta.size = sizeof(struct MLStringBuilder);
         MLDictionaryMeta.size = sizeof(struct MLDictionary);
+        MLPersistentDictionaryMeta.size = sizeof(struct MLPersistentDictionary);
         MLExceptionMeta.size = sizeof(struct MLException);
+        MLFutureMeta.size = sizeof(struct MLFuture);
         MLNullMeta.size = sizeof(struct MLObject);
 
         MLTableCreate(&MLObjectMeta.cache, MLCacheDefaultCapacity);
@@ -1584,9 +5038,13 @@ static void MLBootstrap Metal() {
         MLTableCreate(&MLBlockMeta.cache, MLCacheDefaultCapacity);
         MLTableCreate(&MLDataMeta.cache, MLCacheDefaultCapacity);
         MLTableCreate(&MLArrayMeta.cache, MLCacheDefaultCapacity);
+        MLTableCreate(&MLNumberArrayMeta.cache, MLCacheDefaultCapacity);
         MLTableCreate(&MLStringMeta.cache, MLCacheDefaultCapacity);
+        MLTableCreate(&MLStringBuilderMeta.cache, MLCacheDefaultCapacity);
         MLTableCreate(&MLDictionaryMeta.cache, MLCacheDefaultCapacity);
+        MLTableCreate(&MLPersistentDictionaryMeta.cache, MLCacheDefaultCapacity);
         MLTableCreate(&MLExceptionMeta.cache, MLCacheDefaultCapacity);
+        MLTableCreate(&MLFutureMeta.cache, MLCacheDefaultCapacity);
         MLTableCreate(&MLNullMeta.cache, MLCacheDefaultCapacity);
 
         MLTableCreate(&MLObjectMeta.methods, MLMethodsDefaultCapacity);
@@ -1595,9 +5053,13 @@ static void MLBootstrap Metal() {
         MLTableCreate(&MLBlockMeta.methods, MLMethodsDefaultCapacity);
         MLTableCreate(&MLDataMeta.methods, MLMethodsDefaultCapacity);
         MLTableCreate(&MLArrayMeta.methods, MLMethodsDefaultCapacity);
+        MLTableCreate(&MLNumberArrayMeta.methods, MLMethodsDefaultCapacity);
         MLTableCreate(&MLStringMeta.methods, MLMethodsDefaultCapacity);
+        MLTableCreate(&MLStringBuilderMeta.methods, MLMethodsDefaultCapacity);
         MLTableCreate(&MLDictionaryMeta.methods, MLMethodsDefaultCapacity);
+        MLTableCreate(&MLPersistentDictionaryMeta.methods, MLMethodsDefaultCapacity);
         MLTableCreate(&MLExceptionMeta.methods, MLMethodsDefaultCapacity);
+        MLTableCreate(&MLFutureMeta.methods, MLMethodsDefaultCapacity);
         MLTableCreate(&MLNullMeta.methods, MLMethodsDefaultCapacity);
 
         MLObjectAddMethodBlock(MLObject, MLZero, MLZero, MLStringUncollected("allocate"), MLBlockUncollected(MLObjectAllocate), MLZero);
@@ -1630,6 +5092,7 @@ static void MLBootstrap Metal() {
 
         MLObjectAddMethodBlock(MLNumber, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLNumberCreate), MLZero);
         MLObjectAddMethodBlock(MLNumber, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLNumberAsString), MLZero);
+        MLObjectAddMethodBlock(MLNumber, MLObject, MLZero, MLStringUncollected("parse*"), MLBlockUncollected(MLNumberParseString), MLZero);
         MLObjectAddMethodBlock(MLNumber, MLObject, MLZero, MLStringUncollected("hash"), MLBlockUncollected(MLNumberHash), MLZero);
         MLObjectAddMethodBlock(MLNumber, MLObject, MLZero, MLStringUncollected("equals*"), MLBlockUncollected(MLNumberEquals), MLZero);
         MLObjectAddMethodBlock(MLNumber, MLObject, MLZero, MLStringUncollected("compare*"), MLBlockUncollected(MLNumberCompare), MLZero);
@@ -1637,16 +5100,23 @@ static void MLBootstrap Metal() {
 
         MLObjectAddMethodBlock(MLBlock, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLBlockCreate), MLZero);
         MLObjectAddMethodBlock(MLBlock, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLBlockAsString), MLZero);
+        MLObjectAddMethodBlock(MLBlock, MLObject, MLZero, MLStringUncollected("spawn*"), MLBlockUncollected(MLBlockSpawn), MLZero);
 
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLDataCreate), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLDataDestroy), MLZero);
+        MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("map*"), MLBlockUncollected(MLDataMap), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLDataAsString), MLZero);
+        MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("base64"), MLBlockUncollected(MLDataBase64), MLZero);
+        MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("hex"), MLBlockUncollected(MLDataHex), MLZero);
+        MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("decode-base64*"), MLBlockUncollected(MLDataDecodeBase64), MLZero);
+        MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("decode-hex*"), MLBlockUncollected(MLDataDecodeHex), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("hash"), MLBlockUncollected(MLDataHash), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("equals*"), MLBlockUncollected(MLDataEquals), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("copy"), MLBlockUncollected(MLDataCopy), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("at*count*"), MLBlockUncollected(MLDataAtCount), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("replace-at*count*with*"), MLBlockUncollected(MLDataReplaceAtCountWith), MLZero);
         MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("count"), MLBlockUncollected(MLDataCount), MLZero);
+        MLObjectAddMethodBlock(MLData, MLObject, MLZero, MLStringUncollected("enumerate*"), MLBlockUncollected(MLDataEnumerate), MLZero);
 
         MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLArrayCreate), MLZero);
         MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLArrayDestroy), MLZero);
@@ -1656,8 +5126,30 @@ static void MLBootstrap Metal() {
         MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("copy"), MLBlockUncollected(MLArrayCopy), MLZero);
         MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("at*"), MLBlockUncollected(MLArrayAt), MLZero);
         MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("count"), MLBlockUncollected(MLArrayCount), MLZero);
+        MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("enumerate*"), MLBlockUncollected(MLArrayEnumerate), MLZero);
+        MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("map*"), MLBlockUncollected(MLArrayMap), MLZero);
+        MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("filter*"), MLBlockUncollected(MLArrayFilter), MLZero);
+        MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("reduce*with*"), MLBlockUncollected(MLArrayReduceWith), MLZero);
+        MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("each*"), MLBlockUncollected(MLArrayEach), MLZero);
+        MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("sort"), MLBlockUncollected(MLArraySort), MLZero);
+        MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("sort-by*"), MLBlockUncollected(MLArraySortBy), MLZero);
         MLObjectAddMethodBlock(MLArray, MLObject, MLZero, MLStringUncollected("replace-at*count*with*"), MLBlockUncollected(MLArrayReplaceAtCountWith), MLZero);
 
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLNumberArrayCreate), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLNumberArrayDestroy), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLNumberArrayAsString), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("hash"), MLBlockUncollected(MLNumberArrayHash), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("equals*"), MLBlockUncollected(MLNumberArrayEquals), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("at*"), MLBlockUncollected(MLNumberArrayAt), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("count"), MLBlockUncollected(MLNumberArrayCount), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("replace-at*count*with*"), MLBlockUncollected(MLNumberArrayReplaceAtCountWith), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("sum"), MLBlockUncollected(MLNumberArraySum), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("min"), MLBlockUncollected(MLNumberArrayMin), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("max"), MLBlockUncollected(MLNumberArrayMax), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("scale*"), MLBlockUncollected(MLNumberArrayScale), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("dot*"), MLBlockUncollected(MLNumberArrayDot), MLZero);
+        MLObjectAddMethodBlock(MLNumberArray, MLObject, MLZero, MLStringUncollected("add*"), MLBlockUncollected(MLNumberArrayAdd), MLZero);
+
         MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLStringCreate), MLZero);
         MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLStringDestroy), MLZero);
         MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLStringAsString), MLZero);
@@ -1667,8 +5159,16 @@ static void MLBootstrap Metal() {
         MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("copy"), MLBlockUncollected(MLStringCopy), MLZero);
         MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("at*count*"), MLBlockUncollected(MLStringAtCount), MLZero);
         MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("length"), MLBlockUncollected(MLStringLength), MLZero);
+        MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("as-number"), MLBlockUncollected(MLStringAsNumber), MLZero);
         MLObjectAddMethodBlock(MLString, MLObject, MLZero, MLStringUncollected("replace-at*count*with*"), MLBlockUncollected(MLStringReplaceAtCountWith), MLZero);
 
+        MLObjectAddMethodBlock(MLStringBuilder, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLStringBuilderCreate), MLZero);
+        MLObjectAddMethodBlock(MLStringBuilder, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLStringBuilderDestroy), MLZero);
+        MLObjectAddMethodBlock(MLStringBuilder, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLStringBuilderAsString), MLZero);
+        MLObjectAddMethodBlock(MLStringBuilder, MLObject, MLZero, MLStringUncollected("length"), MLBlockUncollected(MLStringBuilderLength), MLZero);
+        MLObjectAddMethodBlock(MLStringBuilder, MLObject, MLZero, MLStringUncollected("append*"), MLBlockUncollected(MLStringBuilderAppend), MLZero);
+        MLObjectAddMethodBlock(MLStringBuilder, MLObject, MLZero, MLStringUncollected("freeze"), MLBlockUncollected(MLStringBuilderFreeze), MLZero);
+
         MLObjectAddMethodBlock(MLDictionary, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLDictionaryCreate), MLZero);
         MLObjectAddMethodBlock(MLDictionary, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLDictionaryDestroy), MLZero);
         MLObjectAddMethodBlock(MLDictionary, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLDictionaryAsString), MLZero);
@@ -1679,6 +5179,18 @@ static void MLBootstrap Metal() {
         MLObjectAddMethodBlock(MLDictionary, MLObject, MLZero, MLStringUncollected("set*to*"), MLBlockUncollected(MLDictionarySetTo), MLZero);
         MLObjectAddMethodBlock(MLDictionary, MLObject, MLZero, MLStringUncollected("remove*"), MLBlockUncollected(MLDictionaryRemove), MLZero);
         MLObjectAddMethodBlock(MLDictionary, MLObject, MLZero, MLStringUncollected("count"), MLBlockUncollected(MLDictionaryCount), MLZero);
+        MLObjectAddMethodBlock(MLDictionary, MLObject, MLZero, MLStringUncollected("enumerate*"), MLBlockUncollected(MLDictionaryEnumerate), MLZero);
+
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLPersistentDictionaryCreate), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLPersistentDictionaryDestroy), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLPersistentDictionaryAsString), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("hash"), MLBlockUncollected(MLPersistentDictionaryHash), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("equals*"), MLBlockUncollected(MLPersistentDictionaryEquals), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("copy"), MLBlockUncollected(MLPersistentDictionaryCopy), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("get*"), MLBlockUncollected(MLPersistentDictionaryGet), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("set*to*"), MLBlockUncollected(MLPersistentDictionarySetTo), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("remove*"), MLBlockUncollected(MLPersistentDictionaryRemove), MLZero);
+        MLObjectAddMethodBlock(MLPersistentDictionary, MLObject, MLZero, MLStringUncollected("count"), MLBlockUncollected(MLPersistentDictionaryCount), MLZero);
 
         MLObjectAddMethodBlock(MLException, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLExceptionCreate), MLZero);
         MLObjectAddMethodBlock(MLException, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLExceptionDestroy), MLZero);
@@ -1690,6 +5202,12 @@ static void MLBootstrap Metal() {
         MLObjectAddMethodBlock(MLException, MLObject, MLZero, MLStringUncollected("info"), MLBlockUncollected(MLExceptionInfo), MLZero);
         MLObjectAddMethodBlock(MLException, MLObject, MLZero, MLStringUncollected("raise*reason*info*"), MLBlockUncollected(MLExceptionRaiseReasonInfo), MLZero);
 
+        MLObjectAddMethodBlock(MLFuture, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(MLFutureCreate), MLZero);
+        MLObjectAddMethodBlock(MLFuture, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(MLFutureDestroy), MLZero);
+        MLObjectAddMethodBlock(MLFuture, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(MLFutureAsString), MLZero);
+        MLObjectAddMethodBlock(MLFuture, MLObject, MLZero, MLStringUncollected("is-done"), MLBlockUncollected(MLFutureIsDone), MLZero);
+        MLObjectAddMethodBlock(MLFuture, MLObject, MLZero, MLStringUncollected("join"), MLBlockUncollected(MLFutureJoin), MLZero);
+
         MLObjectAddMethodBlock(MLNull, MLObject, MLZero, MLStringUncollected("create"), MLBlockUncollected(NullCreate), MLZero);
         MLObjectAddMethodBlock(MLNull, MLObject, MLZero, MLStringUncollected("destroy"), MLBlockUncollected(NullDestroy), MLZero);
         MLObjectAddMethodBlock(MLNull, MLObject, MLZero, MLStringUncollected("as-string"), MLBlockUncollected(NullAsString), MLZero);
@@ -1702,29 +5220,41 @@ static void MLBootstrap Metal() {
         MLTableCreate(&MLBlockMeta.children, 1);
         MLTableCreate(&MLDataMeta.children, 1);
         MLTableCreate(&MLArrayMeta.children, 1);
+        MLTableCreate(&MLNumberArrayMeta.children, 1);
         MLTableCreate(&MLStringMeta.children, 1);
+        MLTableCreate(&MLStringBuilderMeta.children, 1);
         MLTableCreate(&MLDictionaryMeta.children, 1);
+        MLTableCreate(&MLPersistentDictionaryMeta.children, 1);
         MLTableCreate(&MLExceptionMeta.children, 1);
+        MLTableCreate(&MLFutureMeta.children, 1);
         MLTableCreate(&MLNullMeta.children, 1);
 
-        struct MLEntry booleanEntry = {.key = (MLNatural)MLBoolean, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry numberEntry = {.key = (MLNatural)MLNumber, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry blockEntry = {.key = (MLNatural)MLBlock, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry dataEntry = {.key = (MLNatural)MLData, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry arrayEntry = {.key = (MLNatural)MLArray, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry stringEntry = {.key = (MLNatural)MLString, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry dictionaryEntry = {.key = (MLNatural)MLDictionary, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry exceptionEntry = {.key = (MLNatural)MLException, .value = (MLNatural)MLYes, .extra = 0};
-        struct MLEntry nullEntry = {.key = (MLNatural)MLNull, .value = (MLNatural)MLYes, .extra = 0};
+        struct MLEntry booleanEntry = {.key = (MLNatural)MLBoolean, .value = (MLNatural)MLYes};
+        struct MLEntry numberEntry = {.key = (MLNatural)MLNumber, .value = (MLNatural)MLYes};
+        struct MLEntry blockEntry = {.key = (MLNatural)MLBlock, .value = (MLNatural)MLYes};
+        struct MLEntry dataEntry = {.key = (MLNatural)MLData, .value = (MLNatural)MLYes};
+        struct MLEntry arrayEntry = {.key = (MLNatural)MLArray, .value = (MLNatural)MLYes};
+        struct MLEntry numberArrayEntry = {.key = (MLNatural)MLNumberArray, .value = (MLNatural)MLYes};
+        struct MLEntry stringEntry = {.key = (MLNatural)MLString, .value = (MLNatural)MLYes};
+        struct MLEntry stringBuilderEntry = {.key = (MLNatural)MLStringBuilder, .value = (MLNatural)MLYes};
+        struct MLEntry dictionaryEntry = {.key = (MLNatural)MLDictionary, .value = (MLNatural)MLYes};
+        struct MLEntry persistentDictionaryEntry = {.key = (MLNatural)MLPersistentDictionary, .value = (MLNatural)MLYes};
+        struct MLEntry exceptionEntry = {.key = (MLNatural)MLException, .value = (MLNatural)MLYes};
+        struct MLEntry futureEntry = {.key = (MLNatural)MLFuture, .value = (MLNatural)MLYes};
+        struct MLEntry nullEntry = {.key = (MLNatural)MLNull, .value = (MLNatural)MLYes};
 
         MLTablePut(&MLObjectMeta.children, &booleanEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &numberEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &blockEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &dataEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &arrayEntry, MLZero, MLZero);
+        MLTablePut(&MLObjectMeta.children, &numberArrayEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &stringEntry, MLZero, MLZero);
+        MLTablePut(&MLObjectMeta.children, &stringBuilderEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &dictionaryEntry, MLZero, MLZero);
+        MLTablePut(&MLObjectMeta.children, &persistentDictionaryEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &exceptionEntry, MLZero, MLZero);
+        MLTablePut(&MLObjectMeta.children, &futureEntry, MLZero, MLZero);
         MLTablePut(&MLObjectMeta.children, &nullEntry, MLZero, MLZero);
 
         // TODO: implement.
@@ -1735,12 +5265,17 @@ static void MLBootstrap Metal() {
         MLBlockClassName = MLSend(MLStringUncollected("Block"), "eternize");
         MLDataClassName = MLSend(MLStringUncollected("Data"), "eternize");
         MLArrayClassName = MLSend(MLStringUncollected("Array"), "eternize");
+        MLNumberArrayClassName = MLSend(MLStringUncollected("NumberArray"), "eternize");
         MLStringClassName = MLSend(MLStringUncollected("String"), "eternize");
+        MLStringBuilderClassName = MLSend(MLStringUncollected("StringBuilder"), "eternize");
         MLDictionaryClassName = MLSend(MLStringUncollected("Dictionary"), "eternize");
+        MLPersistentDictionaryClassName = MLSend(MLStringUncollected("PersistentDictionary"), "eternize");
         MLDictionaryClassName = MLSend(MLStringUncollected("Exception"), "eternize");
+        MLFutureClassName = MLSend(MLStringUncollected("Future"), "eternize");
         MLNullClassName = MLSend(MLStringUncollected("null"), "eternize");
         MLNoAsString = MLSend(MLStringUncollected("no"), "eternize");
         MLYesAsString = MLSend(MLStringUncollected("yes"), "eternize");
+        MLFutureInstanceAsString = MLSend(MLStringUncollected("<Future>"), "eternize");
         MLInvalidArgumentException = MLSend(MLStringUncollected("MLInvalidArgumentException"), "eternize");
         MLInternalInconsistencyException = MLSend(MLStringUncollected("MLInternalInconsistencyException"), "eternize");
     }
@@ -1760,8 +5295,62 @@ static void MLArrayEnsureCapacity(struct MLArray* array, MLInteger requiredCapac
     if (requiredCapacity <= MLArrayDefaultCapacity) requiredCapacity = MLArrayDefaultCapacity;
     if (requiredCapacity <= array->capacity) return;
 
+    // Slots freed at the front are taken back before growing, once there are
+    // at least as many as objects to move (queues keep popping the front):
+    MLVariable* base = array->objects - array->head;
+
+    if (array->head >= array->count) {
+        memmove(base, array->objects, array->count * sizeof(MLVariable));
+        array->capacity += array->head;
+        array->objects = base;
+        array->head = 0;
+        if (requiredCapacity <= array->capacity) return;
+    }
+
+    array->capacity = MLRoundUpToPowerOfTwo(requiredCapacity);
+    base = realloc(base, sizeof(MLVariable) * (array->head + array->capacity));
+    array->objects = base + array->head;
+}
+
+// Makes at least `requiredHead` free slots before the objects, with room to
+// spare for as many objects as there are already.
+static void MLArrayEnsureHead(struct MLArray* array, MLInteger requiredHead) {
+    MLInteger const head = MLRoundUpToPowerOfTwo(MLMax(array->count + requiredHead, MLArrayDefaultCapacity));
+    MLVariable* const base = malloc(sizeof(MLVariable) * (head + MLMax(array->capacity, array->count)));
+
+    memcpy(base + head, array->objects, array->count * sizeof(MLVariable));
+    free(array->objects - array->head);
+
+    array->capacity = MLMax(array->capacity, array->count);
+    array->objects = base + head;
+    array->head = head;
+}
+
+// Gives the array objects of its own before it changes, if it shares them.
+static void MLArrayDetach(struct MLArray* array) {
+    if (!MLShareIsShared(&array->shares)) return;
+
+    MLVariable* const shared = array->objects;
+    MLInteger const sharedHead = array->head;
+    array->head = 0;
+    array->capacity = MLRoundUpToPowerOfTwo(MLMax(array->count, MLArrayDefaultCapacity));
+    array->objects = malloc(array->capacity * sizeof(MLVariable));
+    memcpy(array->objects, shared, array->count * sizeof(MLVariable));
+    MLRetainMany(array->count, array->objects);
+
+    // The other sharers may have gone in the meantime:
+    if (MLShareLeave(&array->shares)) {
+        MLReleaseMany(array->count, shared);
+        free(shared - sharedHead);
+    }
+}
+
+static void MLNumberArrayEnsureCapacity(struct MLNumberArray* array, MLInteger requiredCapacity) {
+    if (requiredCapacity <= MLNumberArrayDefaultCapacity) requiredCapacity = MLNumberArrayDefaultCapacity;
+    if (requiredCapacity <= array->capacity) return;
+
     array->capacity = MLRoundUpToPowerOfTwo(requiredCapacity);
-    array->objects = realloc(array->objects, sizeof(MLVariable) * array->capacity);
+    array->values = realloc(array->values, sizeof(double) * array->capacity);
 }
 
 static void MLStringEnsureCapacity(struct MLString* string, MLInteger requiredCapacity) {
@@ -1772,6 +5361,105 @@ static void MLStringEnsureCapacity(struct MLString* string, MLInteger requiredCa
     string->characters = realloc(string->characters, sizeof(char) * (string->capacity + 1));
 }
 
+// Makes an immutable string that owns the given characters, which need room
+// for a trailing '\0'. Short strings are interned instead, like all keys.
+static struct MLString* MLStringTake(MLInteger length, char* characters) {
+    characters[length] = '\0';
+
+    if (length <= MLMaxKeyAndCommandLength) {
+        struct MLString* const string = MLStringMake(length, characters);
+        free(characters);
+        return string;
+    }
+
+    struct MLString* string = calloc(1, sizeof(struct MLString));
+    string->meta = &MLStringMeta;
+    string->retainCountAndFlags = MLRetainCountOne;
+    string->capacity = -1;
+    string->length = length;
+    string->characters = characters;
+    return string;
+}
+
+// Retain and release many objects in a tight loop: eternal objects are
+// skipped, the built-in retain is inlined, and a method is only looked up
+// again when the meta changes from one object to the next.
+static void MLRetainMany(MLInteger count, MLVariable const* objects) {
+    MLVariable const command = MLStringConstant("retain");
+    struct MLMeta* meta = MLZero;
+    MLVariable super = MLZero;
+    MLCode code = MLZero;
+
+    for (MLInteger i = 0; i < count; i += 1) {
+        struct MLObject* const object = objects[i];
+        if (__atomic_load_n(&object->retainCountAndFlags, __ATOMIC_RELAXED) >= MLRetainCountMax) continue;
+
+        if (object->meta != meta) {
+            meta = object->meta;
+            code = MLLookup(object, command, &super);
+        }
+
+        if (code == (MLCode)MLObjectRetain) __atomic_fetch_add(&object->retainCountAndFlags, MLRetainCountOne, __ATOMIC_RELAXED);
+        else code(object, super, command, MLZero);
+    }
+}
+
+static void MLReleaseMany(MLInteger count, MLVariable const* objects) {
+    MLVariable const command = MLStringConstant("release");
+    struct MLMeta* meta = MLZero;
+    MLVariable super = MLZero;
+    MLCode code = MLZero;
+
+    for (MLInteger i = 0; i < count; i += 1) {
+        struct MLObject* const object = objects[i];
+        if (__atomic_load_n(&object->retainCountAndFlags, __ATOMIC_RELAXED) >= MLRetainCountMax) continue;
+
+        if (object->meta != meta) {
+            meta = object->meta;
+            code = MLLookup(object, command, &super);
+        }
+
+        code(object, super, command, MLZero);
+    }
+}
+
+// Makes an immutable array that owns the given objects and their references.
+static struct MLArray* MLArrayTake(MLInteger count, MLVariable* objects) {
+    struct MLArray* array = calloc(1, sizeof(struct MLArray));
+    array->meta = &MLArrayMeta;
+    array->retainCountAndFlags = MLRetainCountOne;
+    array->capacity = -1;
+    array->count = count;
+    array->objects = objects;
+    return array;
+}
+
+// Makes an immutable data object that owns the given bytes.
+static struct MLData* MLDataTake(MLInteger count, void* bytes) {
+    struct MLData* data = calloc(1, sizeof(struct MLData));
+    data->meta = &MLDataMeta;
+    data->retainCountAndFlags = MLRetainCountOne;
+    data->capacity = -1;
+    data->count = count;
+    data->bytes = bytes;
+    return data;
+}
+
+static void MLStringBuilderEnsureCapacity(struct MLStringBuilder* builder, MLInteger requiredCapacity) {
+    if (requiredCapacity <= builder->capacity) return;
+
+    MLInteger const capacity = MLMax(requiredCapacity, MLStringBuilderDefaultCapacity);
+    builder->capacity = MLRoundUpToPowerOfTwo(capacity + 1) - 1;
+    builder->characters = realloc(builder->characters, sizeof(char) * (builder->capacity + 1));
+}
+
+static void MLStringBuilderAppendCharacters(struct MLStringBuilder* builder, MLInteger length, char const* characters) {
+    MLStringBuilderEnsureCapacity(builder, builder->length + length);
+    memcpy(builder->characters + builder->length, characters, length);
+    builder->length += length;
+    builder->characters[builder->length] = '\0';
+}
+
 static void MLDictionaryEnsureCapacity(struct MLDictionary* dictionary, MLInteger requiredCapacity) {
     if (requiredCapacity <= MLDictionaryDefaultCapacity) requiredCapacity = MLDictionaryDefaultCapacity;
 
@@ -1780,23 +5468,121 @@ static void MLDictionaryEnsureCapacity(struct MLDictionary* dictionary, MLIntege
     MLInteger const threeFourthOfOldCapacity = oldCapacity - oneFourthOfOldCapacity;
     MLInteger const newCapacity = MLRoundUpToPowerOfTwo(requiredCapacity + (requiredCapacity >> 1));
 
-    if (requiredCapacity < threeFourthOfOldCapacity) return;
+    if (requiredCapacity + dictionary->tombstones < threeFourthOfOldCapacity) return;
+
+    MLDictionaryResize(dictionary, newCapacity);
+}
 
-    MLVariable* oldEntries = dictionary->entries;
-    MLVariable* newEntries = calloc(sizeof(MLVariable), 2 * newCapacity);
+// Gives the dictionary entries of its own before it changes, if it shares
+// them. Shared entries are never being migrated.
+static void MLDictionaryDetach(struct MLDictionary* dictionary) {
+    if (!MLShareIsShared(&dictionary->shares)) return;
 
-    dictionary->capacity = newCapacity;
-    dictionary->count = 0;
-    dictionary->mask = dictionary->capacity - 1;
-    dictionary->entries = newEntries;
+    MLVariable* const shared = dictionary->entries;
+    MLNatural const slotsCount = (dictionary->mask + 1) * 2;
+    dictionary->entries = malloc(slotsCount * sizeof(MLVariable));
+    memcpy(dictionary->entries, shared, slotsCount * sizeof(MLVariable));
+
+    for (MLNatural index = 0; index < slotsCount; index += 2) {
+        if (shared[index] == MLZero || shared[index] == MLMore) continue;
+        MLSend(shared[index], "retain");
+        MLSend(shared[index + 1], "retain");
+    }
+
+    if (MLShareLeave(&dictionary->shares)) {
+        for (MLNatural index = 0; index < slotsCount; index += 2) {
+            if (shared[index] == MLZero || shared[index] == MLMore) continue;
+            MLSend(shared[index], "release");
+            MLSend(shared[index + 1], "release");
+        }
+        free(shared);
+    }
+}
+
+// Starts migrating the entries over to a table with the new capacity, which
+// happens incrementally in subsequent calls to MLDictionaryMigrate().
+static void MLDictionaryResize(struct MLDictionary* dictionary, MLInteger capacity) {
+    MLDictionaryMigrate(dictionary, MLNaturalMax);
+
+    dictionary->maskOld = dictionary->mask;
+    dictionary->migrated = 0;
+    dictionary->entriesOld = dictionary->entries;
+
+    dictionary->capacity = capacity;
+    dictionary->tombstones = 0;
+    dictionary->mask = capacity - 1;
+    dictionary->entries = calloc(2 * capacity, sizeof(MLVariable));
+
+    if (dictionary->count == 0 || dictionary->entriesOld == MLZero) {
+        MLDictionaryMigrate(dictionary, MLNaturalMax);
+    }
+}
+
+static void MLDictionaryMigrate(struct MLDictionary* dictionary, MLNatural steps) {
+    if (dictionary->entriesOld == MLZero) return;
+
+    MLVariable* const entriesOld = dictionary->entriesOld;
+    MLNatural const capacityOld = dictionary->maskOld + 1;
+    MLNatural const end = MLMin(dictionary->migrated + MLMin(steps, capacityOld), capacityOld);
+
+    for (MLNatural index = dictionary->migrated; index < end; index += 1) {
+        MLVariable key = entriesOld[index * 2];
+        MLVariable value = entriesOld[index * 2 + 1];
+        if (key == MLZero || key == MLMore) continue;
+
+        MLNatural const hash = MLNaturalFrom(MLSend(key, "hash"));
+        MLDictionaryInsert(dictionary, hash, key, value);
+
+        // Leave a tombstone, so that lookups in the old entries can't find
+        // the moved entry anymore, but still probe past it:
+        entriesOld[index * 2] = MLMore;
+        entriesOld[index * 2 + 1] = MLZero;
+    }
+
+    // Moved entries are where an enumeration already was or has yet to be:
+    dictionary->mutations += 1;
+    dictionary->migrated = end;
+    if (end < capacityOld) return;
+
+    free(dictionary->entriesOld);
+    dictionary->entriesOld = MLZero;
+    dictionary->maskOld = 0;
+    dictionary->migrated = 0;
+}
+
+static MLInteger MLDictionaryFind(MLVariable* entries, MLNatural mask, MLNatural hash, MLVariable key) {
+    MLNatural index = hash & mask;
+
+    for (MLNatural i = 0; i <= mask; i += 1) {
+        MLVariable const keyAtIndex = entries[index * 2];
+
+        if (keyAtIndex == MLZero) {
+            return -1;
+        }
+
+        if (keyAtIndex != MLMore && (keyAtIndex == key || MLSend(keyAtIndex, "equals*", key) == MLYes)) {
+            return index;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return -1;
+}
 
-    for (MLInteger index = 0; index < oldCapacity; index += 1) {
-        MLVariable key = oldEntries[index * 2];
-        MLVariable value = oldEntries[index * 2 + 1];
-        if (key) MLDictionarySetTo(dictionary, MLZero, MLZero, key, value, MLZero);
+// Inserts a key/value pair known to be absent into the current entries,
+// taking over the references passed in.
+static void MLDictionaryInsert(struct MLDictionary* dictionary, MLNatural hash, MLVariable key, MLVariable value) {
+    MLNatural const mask = dictionary->mask;
+    MLNatural index = hash & mask;
+
+    while (dictionary->entries[index * 2] != MLZero && dictionary->entries[index * 2] != MLMore) {
+        index = (index + 1) & mask;
     }
 
-    free(oldEntries);
+    if (dictionary->entries[index * 2] == MLMore) dictionary->tombstones -= 1;
+    dictionary->entries[index * 2] = key;
+    dictionary->entries[index * 2 + 1] = value;
 }
 
 static inline MLNatural MLRoundUpToPowerOfTwo(MLNatural number) {
@@ -1824,69 +5610,201 @@ static inline MLNatural MLRoundDownToPowerOfTwo(MLNatural number) {
     return (MLNatural)value;
 }
 
-static MLNatural MLDigest(MLInteger count, const void* bytes) {
-    static uint64_t const defaultSeed = 0;
-    uint64_t const seed = defaultSeed;
-    uint64_t const m = 0xc6a4a7935bd1e995;
-    int64_t const r = 47;
+// MLDigest() never returns 0, so a hash of 0 marks it as not computed yet.
+// Concurrent readers may race to compute it, but all store the same value.
+static inline MLNatural MLDataHashValue(struct MLData* data) {
+    MLNatural hash = __atomic_load_n(&data->hash, __ATOMIC_RELAXED);
+    if (hash != 0) return hash;
 
-    uint64_t h = seed ^ (count * m);
+    hash = MLDigest(data->count, data->bytes);
+    __atomic_store_n(&data->hash, hash, __ATOMIC_RELAXED);
+    return hash;
+}
 
-    const uint64_t* data = (const uint64_t*)bytes;
-    const uint64_t* end = data + (count / 8);
+static inline MLNatural MLStringHashValue(struct MLString* string) {
+    MLNatural hash = __atomic_load_n(&string->hash, __ATOMIC_RELAXED);
+    if (hash != 0) return hash;
 
-    while (data != end) {
-        uint64_t k = *data++;
+    hash = MLDigest(string->length, MLStringCharacters(string));
+    __atomic_store_n(&string->hash, hash, __ATOMIC_RELAXED);
+    return hash;
+}
 
-        k *= m;
-        k ^= k >> r;
-        k *= m;
+// The hash of an object as part of a container's hash. Numbers, strings and
+// data are hashed without a send, consistently with their equals*.
+static inline MLNatural MLElementHashValue(MLVariable object) {
+    struct MLMeta* const meta = object(object).meta;
 
-        h ^= k;
-        h *= m;
+    if (meta == &MLNumberMeta) {
+        double const value = number(object).number;
+        MLNatural bits = 0;
+        if (value != 0) memcpy(&bits, &value, sizeof(bits));
+        return bits;
     }
 
-    const unsigned char* data2 = (const unsigned char*)data;
-    switch (count & 7 /* count % 8 */) {
-        case 7: h ^= (uint64_t)(data2[6]) << 48;
-        case 6: h ^= (uint64_t)(data2[5]) << 40;
-        case 5: h ^= (uint64_t)(data2[4]) << 32;
-        case 4: h ^= (uint64_t)(data2[3]) << 24;
-        case 3: h ^= (uint64_t)(data2[2]) << 16;
-        case 2: h ^= (uint64_t)(data2[1]) << 8;
-        case 1: h ^= (uint64_t)(data2[0]);
-                h *= m;
-    };
+    if (meta == &MLStringMeta) return MLStringHashValue(object);
+    if (meta == &MLDataMeta) return MLDataHashValue(object);
 
-    h ^= h >> r;
-    h *= m;
-    h ^= h >> r;
+    return MLNaturalFrom(MLSend(object, "hash"));
+}
+
+// Container hashes are cached until the container changes, they don't notice
+// objects inside changing, just like keys of a dictionary mustn't change.
+
+// Depends on the order of the objects.
+static MLNatural MLArrayHashValue(struct MLArray* array) {
+    MLNatural hash = __atomic_load_n(&array->hash, __ATOMIC_RELAXED);
+    if (hash != 0) return hash;
+
+    hash = MLDigestSecret[0] ^ (MLNatural)array->count;
+    for (MLInteger i = 0; i < array->count; i += 1) {
+        hash = MLDigestMix(hash ^ MLElementHashValue(array->objects[i]), MLDigestSecret[1]);
+    }
+
+    hash = hash != 0 ? hash : 1;
+    __atomic_store_n(&array->hash, hash, __ATOMIC_RELAXED);
+    return hash;
+}
+
+// Sums a hash per entry, so it doesn't depend on the order of the entries.
+static MLNatural MLDictionaryHashValue(struct MLDictionary* dictionary) {
+    MLNatural hash = __atomic_load_n(&dictionary->hash, __ATOMIC_RELAXED);
+    if (hash != 0) return hash;
+
+    hash = MLDigestSecret[0] ^ (MLNatural)dictionary->count;
+    MLVariable* const entriesList[] = {dictionary->entries, dictionary->entriesOld};
+    MLNatural const masks[] = {dictionary->mask, dictionary->maskOld};
+
+    for (int list = 0; list < 2; list += 1) {
+        MLVariable* const entries = entriesList[list];
+        if (entries == MLZero) continue;
+
+        for (MLNatural index = 0; index <= masks[list]; index += 1) {
+            MLVariable const key = entries[index * 2];
+            if (key == MLZero || key == MLMore) continue;
+            MLNatural const keyHash = MLElementHashValue(key) ^ MLDigestSecret[2];
+            MLNatural const valueHash = MLElementHashValue(entries[index * 2 + 1]) ^ MLDigestSecret[3];
+            hash += MLDigestMix(keyHash, valueHash);
+        }
+    }
+
+    hash = hash != 0 ? hash : 1;
+    __atomic_store_n(&dictionary->hash, hash, __ATOMIC_RELAXED);
+    return hash;
+}
+
+// Sums the same hash per entry as MLDictionaryHashValue(), without the count.
+static MLNatural MLTrieHashValue(struct MLTrieNode* node) {
+    MLNatural hash = 0;
+
+    for (MLNatural index = 0; index < node->count; index += 1) {
+        MLVariable const key = node->slots[index * 2];
+        MLVariable const value = node->slots[index * 2 + 1];
+
+        if (key == MLZero) {
+            hash += MLTrieHashValue(value);
+            continue;
+        }
+
+        hash += MLDigestMix(MLElementHashValue(key) ^ MLDigestSecret[2], MLElementHashValue(value) ^ MLDigestSecret[3]);
+    }
 
-    MLNatural hash = (MLNatural)h;
-    if (hash == MLNaturalMax) hash = MLNaturalMax - 1;
-    if (hash == MLNaturalMin) hash = MLNaturalMin + 1;
     return hash;
 }
 
-static inline MLNatural MLStringHashFunction(MLNatural key) {
-    struct MLString* string = (struct MLString*)key;
+// Frees an immutable string that can't be reached by lookups anymore.
+static void MLStringReclaim(void* string) {
+    free(string(string).characters);
+    free(string);
+}
+
+// Loads go through memcpy(), which compiles to a plain unaligned load where
+// that is allowed and stays well-defined for any alignment of `bytes`.
+static inline uint64_t MLDigestRead64(uint8_t const* bytes) {
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t MLDigestRead32(uint8_t const* bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t MLDigestMix(uint64_t value1, uint64_t value2) {
+    __uint128_t const product = (__uint128_t)value1 * value2;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
 
-    // TODO: is testing for MLZero or MLMore really needed here?
-    if (string == MLZero) return 0;
-    if (string == MLMore) return MLNaturalMax;
+// Consumes 64 bytes at a time, kept out of line so that short inputs don't
+// pay for the registers the lanes need.
+static __attribute__((noinline)) uint64_t MLDigestBulk(uint8_t const** bytes, MLInteger* count, uint64_t seed) {
+    uint8_t const* data = *bytes;
+    MLInteger remaining = *count;
+    uint64_t lane1 = seed;
+    uint64_t lane2 = seed;
+    uint64_t lane3 = seed;
 
-    return string(string).hash;
+    do {
+        seed = MLDigestMix(MLDigestRead64(data) ^ MLDigestSecret[1], MLDigestRead64(data + 8) ^ seed);
+        lane1 = MLDigestMix(MLDigestRead64(data + 16) ^ MLDigestSecret[2], MLDigestRead64(data + 24) ^ lane1);
+        lane2 = MLDigestMix(MLDigestRead64(data + 32) ^ MLDigestSecret[3], MLDigestRead64(data + 40) ^ lane2);
+        lane3 = MLDigestMix(MLDigestRead64(data + 48) ^ MLDigestSecret[0], MLDigestRead64(data + 56) ^ lane3);
+        data += 64;
+        remaining -= 64;
+    } while (remaining >= 64);
+
+    *bytes = data;
+    *count = remaining;
+    return seed ^ lane1 ^ lane2 ^ lane3;
 }
 
-static inline bool MLStringEqualsFunction(MLNatural key1, MLNatural key2) {
-    struct MLString* string1 = (struct MLString*)key1;
-    struct MLString* string2 = (struct MLString*)key2;
-    if (string1 == string2) return true;
+// A wyhash-style digest: inputs of up to 16 bytes are read with two possibly
+// overlapping loads, longer ones are consumed 16 or 64 bytes at a time.
+static MLNatural MLDigest(MLInteger count, const void* bytes) {
+    uint8_t const* data = bytes;
+    uint64_t seed = MLDigestMix(MLDigestSecret[0], MLDigestSecret[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    if (count <= 16) {
+        if (count >= 8) {
+            a = MLDigestRead64(data);
+            b = MLDigestRead64(data + count - 8);
+        }
+        else if (count >= 4) {
+            a = MLDigestRead32(data);
+            b = MLDigestRead32(data + count - 4);
+        }
+        else if (count > 0) {
+            a = ((uint64_t)data[0] << 16) | ((uint64_t)data[count >> 1] << 8) | data[count - 1];
+        }
+    }
+
+    else {
+        MLInteger remaining = count;
+
+        if (remaining >= 64) {
+            seed = MLDigestBulk(&data, &remaining, seed);
+        }
+
+        while (remaining > 16) {
+            seed = MLDigestMix(MLDigestRead64(data) ^ MLDigestSecret[1], MLDigestRead64(data + 8) ^ seed);
+            data += 16;
+            remaining -= 16;
+        }
+
+        a = MLDigestRead64(data + remaining - 16);
+        b = MLDigestRead64(data + remaining - 8);
+    }
 
-    // TODO: is testing for MLZero or MLMore really needed here?
-    if (string1 == MLZero || string2 == MLZero) return false;
-    if (string1 == MLMore || string2 == MLMore) return false;
+    __uint128_t const product = (__uint128_t)(a ^ MLDigestSecret[1]) * (b ^ seed);
+    uint64_t const h = MLDigestMix((uint64_t)product ^ MLDigestSecret[0] ^ (uint64_t)count, (uint64_t)(product >> 64) ^ MLDigestSecret[1]);
 
-    if (string(string1).length != string(string2).length) return false;
-    return strncmp(string(string1).characters, string(string2).characters, string(string1).length) == 0;
+    MLNatural hash = (MLNatural)h;
+    if (hash == MLNaturalMax) hash = MLNaturalMax - 1;
+    if (hash == MLNaturalMin) hash = MLNaturalMin + 1;
+    return hash;
 }
+
@@ -29,23 +29,32 @@
 
 #define ML_METAL_VERSION "x.x.x"
 
+// MLPerform doesn't save the signal mask by default, which would cost a system
+// call each time. Define as 1 to have exceptions restore the mask.
+#ifndef ML_METAL_SAVE_SIGNAL_MASK
+#define ML_METAL_SAVE_SIGNAL_MASK 0
+#endif
+
 #define MLZero (void*)0ul
 #define MLMore (void*)ULLONG_MAX
 
 #define MLMetalHelperJoinJoin(x, y) x ## y
 #define MLMetalHelperJoin(x, y) MLMetalHelperJoinJoin(x, y)
-#define MLMetalHelperStringify(x) (((char*)(#x))[0] == '"' ? MLString(x) : (x))
+#define MLMetalHelperStringify(x) (((char*)(#x))[0] == '"' ? MLStringConstant(x) : (x))
 
 #define MLLoad __attribute__((constructor(255))) static void MLMetalHelperJoin(__MetalLoadBlock, __COUNTER__)()
 #define MLCollect for (void* collectBlock = MLCollectBlockPush(); collectBlock != MLZero; collectBlock = MLCollectBlockPop(collectBlock))
 
-#define MLPerform for (void* performHandleBlock = MLPerformHandleBlockPush(); performHandleBlock != MLZero; performHandleBlock = MLPerformHandleBlockPop(performHandleBlock)) if (!setjmp(MLPerformHandleBlockPerform(performHandleBlock)))
+#define MLPerform for (struct MLPerformHandleBlock performHandleBlockFrame, * performHandleBlock = MLPerformHandleBlockPush(&performHandleBlockFrame); performHandleBlock != MLZero; performHandleBlock = MLPerformHandleBlockPop(performHandleBlock)) if (!sigsetjmp(performHandleBlock->destination, ML_METAL_SAVE_SIGNAL_MASK))
 #define MLHandle else for (MLVariable exception = MLPerformHandleBlockHandle(performHandleBlock); exception != MLNull; exception = MLNull)
 
+#define MLForEach(object, enumerable) MLMetalHelperForEach(object, enumerable, MLMetalHelperJoin(enumeration, __COUNTER__))
+#define MLMetalHelperForEach(object, enumerable, enumeration) for (struct MLEnumeration enumeration = {.collection = (enumerable)}; enumeration.collection != MLZero; enumeration.collection = MLZero) for (MLVariable object; (object = MLEnumerationNext(&enumeration)) != MLZero;)
+
 #define MLSend(self, command, ...) ({MLVariable const selfToSend = (self); MLVariable const commandToSend = MLMetalHelperStringify(command); MLVariable superToSend = MLZero; MLCode const codeToCall = MLLookup(self, commandToSend, &superToSend); codeToCall(selfToSend, superToSend, commandToSend, ## __VA_ARGS__, MLZero);})
 #define MLSuper(self, command, ...) ({MLVariable const selfToSend = (self); MLVariable const commandToSend = MLMetalHelperStringify(command); MLVariable superToSend = MLZero; MLCode const codeToCall = MLLookup(super, commandToSend, &superToSend); codeToCall(selfToSend, superToSend, commandToSend, ## __VA_ARGS__, MLZero);})
 
-#define MLOption(name, initial) ({ MLVariable nameAsString = MLMetalHelperStringify(name); va_list list; va_start(list, options); MLVariable key = options; MLVariable value = MLZero; while (key != MLZero && key != (nameAsString)) { value = va_arg(list, MLVariable); key = va_arg(list, MLVariable); } va_end(list); key ? va_arg(list, MLVariable) : (initial); });
+#define MLOption(name, initial) ({ MLVariable nameAsString = MLMetalHelperStringify(name); va_list list; va_start(list, options); MLVariable key = options; MLVariable value = MLZero; while (key != MLZero && key != (nameAsString)) { value = va_arg(list, MLVariable); key = va_arg(list, MLVariable); } value = key ? va_arg(list, MLVariable) : (initial); va_end(list); value; });
 #define MLOptions(...) __VA_ARGS__
 
 #define MLBoolean(boolean) ((boolean) ? MLYes : MLNo)
@@ -55,13 +64,16 @@
 #define MLArray(...) MLCollectBlockAdd(MLArrayUncollected(__VA_ARGS__))
 #define MLString(string) MLCollectBlockAdd(MLStringUncollected(string))
 #define MLDictionary(...) MLCollectBlockAdd(MLDictionaryUncollected(__VA_ARGS__))
+#define MLPersistentDictionary(...) MLCollectBlockAdd(MLPersistentDictionaryUncollected(__VA_ARGS__))
 
 #define MLNumberUncollected(number) MLNumberMake((MLDecimal)(number))
 #define MLBlockUncollected(code) MLBlockMake((void*)(code))
 #define MLDataUncollected(data) MLDataMake(sizeof(data), (void*)(data))
 #define MLArrayUncollected(...) MLArrayMake((sizeof((MLVariable[]){MLZero, ## __VA_ARGS__}) / sizeof(MLVariable)) - 1, ## __VA_ARGS__, MLZero)
 #define MLStringUncollected(string) MLStringMake(sizeof(string), (string))
+#define MLStringConstant(string) ({ static struct MLStringConstant constant = {.length = sizeof(string)}; MLVariable const resolved = __atomic_load_n(&constant.resolved, __ATOMIC_ACQUIRE); resolved != MLZero ? resolved : MLStringConstantResolve(&constant, (char const*)(string)); })
 #define MLDictionaryUncollected(...) MLDictionaryMake((sizeof((MLVariable[]){MLZero, ## __VA_ARGS__}) / sizeof(MLVariable)) - 1, ## __VA_ARGS__, MLZero)
+#define MLPersistentDictionaryUncollected(...) MLPersistentDictionaryMake((sizeof((MLVariable[]){MLZero, ## __VA_ARGS__}) / sizeof(MLVariable)) - 1, ## __VA_ARGS__, MLZero)
 
 #define MLIntegerMax ((MLInteger)LONG_MAX)
 #define MLIntegerMin ((MLInteger)LONG_MIN)
@@ -78,15 +90,64 @@ typedef unsigned long MLNatural;
 typedef double MLDecimal;
 typedef MLVariable (*MLCode)(MLVariable, MLVariable, ...);
 
+// Static storage for a string literal, laid out like a String so it can be
+// interned as it is. Used by MLStringConstant(), which resolves it to the
+// interned string on first use.
+struct MLStringConstant {
+    void* meta;
+    MLNatural retainCountAndFlags;
+    MLInteger capacity;
+    MLInteger length;
+    MLNatural hash;
+    void* parent;
+    void* views;
+    MLInteger viewIndex;
+    char const* characters;
+    void* rope;
+    MLVariable resolved;
+};
+
+// State of an enumeration with MLForEach(). Each `enumerate*` sent to the
+// collection points `objects` at its next `count` objects, either inside the
+// collection itself or in `buffer`, `state` is up to the collection. The
+// collection also points `mutations` at a counter it changes whenever it is
+// mutated, so that enumerating a mutated collection fails instead of reading
+// stale objects.
+struct MLEnumeration {
+    MLVariable collection;
+    MLNatural state;
+    MLInteger count;
+    MLInteger index;
+    MLVariable* objects;
+    MLNatural const* mutations;
+    MLNatural mutationsSeen;
+    MLVariable buffer[16];
+};
+
+// A frame of MLPerform, which lives on the stack of the function using it.
+// MLRaise() pops the collect blocks above its `collectBlock` and jumps to the
+// `destination` of the top-most one.
+struct MLPerformHandleBlock {
+    struct MLPerformHandleBlock* previousPerformHandleBlock;
+    void* collectBlock;
+    sigjmp_buf destination;
+    MLVariable exception;
+    bool raised;
+};
+
 extern MLVariable const MLObject;
 extern MLVariable const MLBoolean;
 extern MLVariable const MLNumber;
 extern MLVariable const MLBlock;
 extern MLVariable const MLData;
 extern MLVariable const MLArray;
+extern MLVariable const MLNumberArray;
 extern MLVariable const MLString;
+extern MLVariable const MLStringBuilder;
 extern MLVariable const MLDictionary;
+extern MLVariable const MLPersistentDictionary;
 extern MLVariable const MLException;
+extern MLVariable const MLFuture;
 
 extern MLVariable const MLNull;
 extern MLVariable const MLYes;
@@ -99,6 +160,8 @@ MLVariable MLDataMake(long count, const void* bytes);
 MLVariable MLArrayMake(long count, ...);
 MLVariable MLStringMake(long length, const char* characters);
 MLVariable MLDictionaryMake(long count, ...);
+MLVariable MLPersistentDictionaryMake(long count, ...);
+MLVariable MLStringConstantResolve(struct MLStringConstant* constant, const char* characters);
 
 MLInteger MLIntegerFrom(MLVariable number);
 MLNatural MLNaturalFrom(MLVariable number);
@@ -108,10 +171,11 @@ void* MLCollectBlockPush();
 void* MLCollectBlockPop(void* collectBlock);
 MLVariable MLCollectBlockAdd(MLVariable object);
 
-void* MLPerformHandleBlockPush();
-void* MLPerformHandleBlockPop(void* performHandleBlock);
-void* MLPerformHandleBlockPerform(void* performHandleBlock);
-MLVariable MLPerformHandleBlockHandle(void* performHandleBlock);
+struct MLPerformHandleBlock* MLPerformHandleBlockPush(struct MLPerformHandleBlock* performHandleBlock);
+struct MLPerformHandleBlock* MLPerformHandleBlockPop(struct MLPerformHandleBlock* performHandleBlock);
+MLVariable MLPerformHandleBlockHandle(struct MLPerformHandleBlock* performHandleBlock);
+
+MLVariable MLEnumerationNext(struct MLEnumeration* enumeration);
 
 MLVariable MLImport(const char* name);
 MLVariable MLExport(const char* name, void* code);
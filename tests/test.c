@@ -24,11 +24,21 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 // --------------------------------------------------- Constants & Macros ------
 
-#define AssertRaises(message) for (void* performHandleBlock = MLPerformHandleBlockPush(); performHandleBlock != MLZero; ({ AssertNotNull(MLPerformHandleBlockHandle(performHandleBlock), message); true; }) && (performHandleBlock = MLPerformHandleBlockPop(performHandleBlock))) if (!setjmp(MLPerformHandleBlockPerform(performHandleBlock)))
-#define AssertNotRaises(message) for (void* performHandleBlock = MLPerformHandleBlockPush(); performHandleBlock != MLZero; ({ AssertNull(MLPerformHandleBlockHandle(performHandleBlock), message); true; }) && (performHandleBlock = MLPerformHandleBlockPop(performHandleBlock))) if (!setjmp(MLPerformHandleBlockPerform(performHandleBlock)))
+#define AssertRaises(message) for (struct MLPerformHandleBlock performHandleBlockFrame, * volatile performHandleBlock = MLPerformHandleBlockPush(&performHandleBlockFrame); performHandleBlock != MLZero; ({ AssertNotNull(MLPerformHandleBlockHandle(performHandleBlock), message); true; }) && (performHandleBlock = MLPerformHandleBlockPop(performHandleBlock))) if (!sigsetjmp(performHandleBlock->destination, ML_METAL_SAVE_SIGNAL_MASK))
+#define AssertNotRaises(message) for (struct MLPerformHandleBlock performHandleBlockFrame, * volatile performHandleBlock = MLPerformHandleBlockPush(&performHandleBlockFrame); performHandleBlock != MLZero; ({ AssertNull(MLPerformHandleBlockHandle(performHandleBlock), message); true; }) && (performHandleBlock = MLPerformHandleBlockPop(performHandleBlock))) if (!sigsetjmp(performHandleBlock->destination, ML_METAL_SAVE_SIGNAL_MASK))
+
+// Unlike MLString() and MLData(), these don't include the trailing '\0':
+#define StringWithoutNull(string) MLCollectBlockAdd(MLStringMake(sizeof(string) - 1, (string)))
+#define DataWithoutNull(data) MLCollectBlockAdd(MLDataMake(sizeof(data) - 1, (data)))
 
 static const char* const WHITE = "\x1B[0;97m";
 static const char* const RED = "\x1B[0;31m";
@@ -142,8 +152,43 @@ static void TestObjectWarn() {
     // TODO: implement.
 }
 
+static long TestObjectReleasesCount = 0;
+
+static MLVariable TestObjectCountRelease(MLVariable self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    TestObjectReleasesCount += 1;
+    return MLSuper(self, "release");
+}
+
 static void TestObjectFail() {
-    // TODO: implement.
+    MLVariable object = MLSend(MLObject, "create");
+    MLSend(object, "add-method*block*", MLString("release"), MLBlock(TestObjectCountRelease));
+
+    TestObjectReleasesCount = 0;
+    AssertRaises("Object fail* raises an exception") MLCollect {
+        MLCollect {
+            MLCollectBlockAdd(MLSend(object, "retain"));
+            MLSend(object, "fail*", MLString("TestException | Failed"));
+        }
+    }
+    AssertEquals(MLNumber(TestObjectReleasesCount), MLNumber(1), "Object fail* releases the objects collected in the blocks it leaves");
+
+    MLVariable number = MLNumber(7);
+    AssertRaises("Object fail* raises an exception") MLSend(number, "fail*", MLString("TestException | Failed"));
+    AssertEquals(number, MLNumber(7), "Object fail* keeps the objects collected before the perform block");
+}
+
+static void TestObjectFailUnhandled() {
+    pid_t const child = fork();
+
+    if (child == 0) {
+        freopen("/dev/null", "w", stderr);
+        MLSend(MLObject, "fail*", MLString("TestException | Failed without a handler"));
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    AssertYes(MLBoolean(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT), "Object fail* aborts when no perform block handles the exception");
 }
 
 static void TestObjectDebug() {
@@ -165,6 +210,7 @@ static void TestObject() {
     TestObjectSetProto();
     TestObjectWarn();
     TestObjectFail();
+    TestObjectFailUnhandled();
     TestObjectDebug();
 }
 
@@ -239,7 +285,45 @@ static void TestNumberDestroy() {
 }
 
 static void TestNumberAsString() {
-    // TODO: implement.
+    AssertEquals(MLSend(MLNumber(42), "as-string"), StringWithoutNull("42"), "Number as-string prints integers without a fraction");
+    AssertEquals(MLSend(MLNumber(-7), "as-string"), StringWithoutNull("-7"), "Number as-string prints negative integers");
+    AssertEquals(MLSend(MLNumber(0.1), "as-string"), StringWithoutNull("0.1"), "Number as-string prints the shortest digits that read back as the same number");
+    AssertEquals(MLSend(MLNumber(-123.456), "as-string"), StringWithoutNull("-123.456"), "Number as-string prints decimals without trailing zeros");
+    AssertEquals(MLSend(MLNumber(1e21), "as-string"), StringWithoutNull("1e+21"), "Number as-string prints large numbers with an exponent");
+    AssertEquals(MLSend(MLNumber(1e20), "as-string"), StringWithoutNull("100000000000000000000"), "Number as-string prints numbers below 1e21 in full");
+    AssertEquals(MLSend(MLNumber(0.000001), "as-string"), StringWithoutNull("0.000001"), "Number as-string prints numbers from 1e-6 on without an exponent");
+    AssertEquals(MLSend(MLNumber(1.5e-7), "as-string"), StringWithoutNull("1.5e-7"), "Number as-string prints small numbers with an exponent");
+    AssertEquals(MLSend(MLNumber(5e-324), "as-string"), StringWithoutNull("5e-324"), "Number as-string prints the smallest denormal");
+    AssertEquals(MLSend(MLNumber(1.7976931348623157e308), "as-string"), StringWithoutNull("1.7976931348623157e+308"), "Number as-string prints the largest number");
+}
+
+static void TestNumberParse() {
+    AssertEquals(MLSend(MLNumber, "parse*", StringWithoutNull("42")), MLNumber(42), "Number parse* parses integers");
+    AssertEquals(MLSend(MLNumber, "parse*", MLString("-0.125")), MLNumber(-0.125), "Number parse* parses decimals (here: a literal with a trailing '\\0')");
+    AssertEquals(MLSend(MLNumber, "parse*", StringWithoutNull("1.5e-7")), MLNumber(1.5e-7), "Number parse* parses exponents");
+    AssertEquals(MLSend(MLNumber, "parse*", StringWithoutNull("2.2250738585072011e-308")), MLNumber(2.2250738585072011e-308), "Number parse* parses numbers beyond the fast path");
+    AssertEquals(MLSend(MLNumber, "parse*", StringWithoutNull("123456789012345678901234567890")), MLNumber(123456789012345678901234567890.0), "Number parse* parses numbers with many digits");
+    AssertEquals(MLSend(StringWithoutNull("3.25"), "as-number"), MLNumber(3.25), "String as-number parses the string");
+    AssertRaises("Number parse* raises an exception for strings that aren't numbers") MLSend(MLNumber, "parse*", StringWithoutNull("12abc"));
+    AssertRaises("Number parse* raises an exception for empty strings") MLSend(MLNumber, "parse*", StringWithoutNull(""));
+    AssertRaises("Number parse* raises an exception for strings with a '\\0' before the end") MLSend(MLNumber, "parse*", StringWithoutNull("1\0junk"));
+    AssertRaises("Number parse* raises an exception for exponents without digits") MLSend(MLNumber, "parse*", StringWithoutNull("1e"));
+
+    // Formatting and parsing round-trip:
+    uint64_t bits = 0x9E3779B97F4A7C15ull;
+    int mismatches = 0;
+    for (int i = 0; i < 10000; i += 1) {
+        bits = bits * 6364136223846793005ull + 1442695040888963407ull;
+        MLDecimal number = 0;
+        memcpy(&number, &bits, sizeof(number));
+        if (isnan(number) || isinf(number)) continue;
+
+        MLCollect {
+            MLVariable parsed = MLSend(MLSend(MLNumber(number), "as-string"), "as-number");
+            if (MLDecimalFrom(parsed) != number) mismatches += 1;
+        }
+    }
+    AssertEquals(MLNumber(mismatches), MLNumber(0), "Number as-string and parse* round-trip random numbers");
 }
 
 static void TestNumberIsMutable() {
@@ -269,6 +353,7 @@ static void TestNumber() {
     TestNumberDestroy();
     TestNumberCreate();
     TestNumberAsString();
+    TestNumberParse();
     TestNumberIsMutable();
     TestNumberEquals();
     TestNumberCompare();
@@ -281,8 +366,49 @@ static void TestBlockEquals() {
     // TODO: implement.
 }
 
+static MLVariable TestBlockSquare(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    return MLNumber(MLDecimalFrom(number) * MLDecimalFrom(number));
+}
+
+static MLVariable TestBlockFibonacci(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    long const n = MLIntegerFrom(number);
+    if (n < 2) return number;
+
+    MLVariable future = MLSend(block, "spawn*", MLNumber(n - 1));
+    MLVariable second = TestBlockFibonacci(block, MLZero, MLZero, MLNumber(n - 2), MLZero);
+    MLVariable first = MLSend(future, "join");
+    return MLNumber(MLIntegerFrom(first) + MLIntegerFrom(second));
+}
+
+static MLVariable TestBlockFail(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    return MLSend(number, "fail*", MLString("TestException | Failed"));
+}
+
+static void TestBlockSpawn() {
+    MLVariable futures = MLArray(MLMore);
+    for (long i = 0; i < 100; i += 1) {
+        MLVariable future = MLSend(MLBlock(TestBlockSquare), "spawn*", MLNumber(i));
+        MLSend(futures, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(future));
+    }
+
+    AssertYes(MLSend(MLSend(futures, "at*", MLNumber(0)), "is-kind-of*", MLFuture), "Block spawn* returns a future");
+    AssertEquals(MLSend(MLSend(futures, "at*", MLNumber(7)), "join"), MLNumber(49), "Future join returns the result of the spawned block");
+    AssertEquals(MLSend(MLSend(futures, "at*", MLNumber(99)), "join"), MLNumber(9801), "Future join waits for the spawned block");
+    AssertYes(MLSend(MLSend(futures, "at*", MLNumber(99)), "is-done"), "Future is done once joined");
+    AssertEquals(MLSend(MLSend(futures, "at*", MLNumber(99)), "join"), MLNumber(9801), "Future join returns the same result when joined again");
+    AssertEquals(MLSend(MLSend(futures, "at*", MLNumber(0)), "as-string"), MLSend(MLSend(futures, "at*", MLNumber(1)), "as-string"), "Future as-string returns the same string for every future");
+
+    MLVariable fibonacci = MLSend(MLBlock(TestBlockFibonacci), "spawn*", MLNumber(15));
+    AssertEquals(MLSend(fibonacci, "join"), MLNumber(610), "Future join runs other tasks while blocks spawned by blocks wait");
+
+    MLVariable failure = MLSend(MLBlock(TestBlockFail), "spawn*", MLNumber(1));
+    AssertRaises("Future join raises the exception raised by the spawned block") MLSend(failure, "join");
+    AssertRaises("Future create raises an exception") MLSend(MLFuture, "create");
+}
+
 static void TestBlock() {
     TestBlockEquals();
+    TestBlockSpawn();
 }
 
 // ----------------------------------------------------------- Data Tests ------
@@ -303,8 +429,158 @@ static void TestDataEquals() {
     AssertNo(MLSend(data1, "equals*", MLNumber(9)), "Data equals* returns MLNo when comparing a data object to a number (here: 9)");
 }
 
+static void TestDataReplaceAtCountWith() {
+    MLVariable data = MLSend(MLData, "create", MLString("mutable"), MLYes);
+    MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(0), DataWithoutNull("hello world"));
+    AssertEquals(data, DataWithoutNull("hello world"), "Data replace-at*count*with* inserts bytes into an empty data object");
+    AssertEquals(MLSend(data, "hash"), MLSend(DataWithoutNull("hello world"), "hash"), "Data hash is computed from the bytes of a mutable data object");
+
+    MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(5), DataWithoutNull("goodbye"));
+    AssertEquals(data, DataWithoutNull("goodbye world"), "Data replace-at*count*with* replaces a range of bytes");
+    AssertEquals(MLSend(data, "hash"), MLSend(DataWithoutNull("goodbye world"), "hash"), "Data replace-at*count*with* invalidates the cached hash");
+
+    AssertRaises("Data replace-at*count*with* raises an exception when sent to an immutable data object") MLSend(MLData("12345"), "replace-at*count*with*", MLNumber(0), MLNumber(1), MLData("x"));
+}
+
+static void TestDataAtCount() {
+    char bytes[256];
+    for (int i = 0; i < 256; i += 1) bytes[i] = (char)i;
+
+    MLVariable data = MLCollectBlockAdd(MLDataMake(256, bytes));
+    MLVariable slice = MLSend(data, "at*count*", MLNumber(10), MLNumber(100));
+    MLVariable sliceOfSlice = MLSend(slice, "at*count*", MLNumber(50), MLNumber(40));
+    AssertEquals(slice, MLCollectBlockAdd(MLDataMake(100, bytes + 10)), "Data at*count* returns the bytes in the given range");
+    AssertEquals(sliceOfSlice, MLCollectBlockAdd(MLDataMake(40, bytes + 60)), "Data at*count* returns the bytes in the given range of a slice");
+    AssertEquals(MLSend(data, "at*count*", MLNumber(250), MLNumber(10)), MLCollectBlockAdd(MLDataMake(6, bytes + 250)), "Data at*count* clamps the count to the end of the data");
+    AssertRaises("Data at*count* raises an exception when the index is out of range") MLSend(data, "at*count*", MLNumber(257), MLNumber(1));
+}
+
+static void TestDataAtCountOfMutable() {
+    char bytes[256];
+    for (int i = 0; i < 256; i += 1) bytes[i] = (char)i;
+
+    MLVariable data = MLSend(MLData, "create", MLString("mutable"), MLYes);
+    MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(0), MLCollectBlockAdd(MLDataMake(256, bytes)));
+    MLVariable slice1 = MLSend(data, "at*count*", MLNumber(0), MLNumber(100));
+    MLVariable slice2 = MLSend(data, "at*count*", MLNumber(100), MLNumber(100));
+    MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(256), DataWithoutNull("replaced"));
+    AssertEquals(slice1, MLCollectBlockAdd(MLDataMake(100, bytes)), "Data at*count* slices keep their bytes when the parent changes");
+    AssertEquals(slice2, MLCollectBlockAdd(MLDataMake(100, bytes + 100)), "Data at*count* slices keep their bytes when the parent changes (here: second slice)");
+}
+
+static void TestDataMap() {
+    char bytes[8192];
+    for (int i = 0; i < 8192; i += 1) bytes[i] = (char)(i * 7);
+
+    FILE* file = fopen("/tmp/metal-test-map.data", "wb");
+    fwrite(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    fclose(fopen("/tmp/metal-test-map-empty.data", "wb"));
+
+    MLVariable expected = MLCollectBlockAdd(MLDataMake(sizeof(bytes), bytes));
+    MLVariable data = MLSend(MLData, "map*", MLString("/tmp/metal-test-map.data"));
+    AssertEquals(MLSend(data, "count"), MLNumber(8192), "Data map* returns data with the size of the file");
+    AssertEquals(data, expected, "Data map* returns the contents of the file");
+    AssertEquals(MLSend(data, "hash"), MLSend(expected, "hash"), "Data map* returns data with the same hash as equal heap data");
+    AssertEquals(MLSend(data, "at*count*", MLNumber(4000), MLNumber(100)), MLCollectBlockAdd(MLDataMake(100, bytes + 4000)), "Data at*count* works on mapped data");
+    AssertRaises("Data replace-at*count*with* raises an exception when sent to mapped data") MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(1), MLData("x"));
+
+    MLVariable sequential = MLSend(MLData, "map*", MLString("/tmp/metal-test-map.data"), MLString("access"), MLString("sequential"));
+    AssertEquals(sequential, expected, "Data map* accepts an access hint (here: sequential)");
+    MLVariable empty = MLSend(MLData, "map*", MLString("/tmp/metal-test-map-empty.data"));
+    AssertEquals(MLSend(empty, "count"), MLNumber(0), "Data map* returns empty data for an empty file");
+
+    AssertRaises("Data map* raises an exception when the file doesn't exist") MLSend(MLData, "map*", MLString("/tmp/metal-test-map-missing.data"));
+    AssertRaises("Data map* raises an exception when the access hint is unknown") MLSend(MLData, "map*", MLString("/tmp/metal-test-map.data"), MLString("access"), MLString("backwards"));
+
+    remove("/tmp/metal-test-map.data");
+    remove("/tmp/metal-test-map-empty.data");
+}
+
+static void TestDataBase64() {
+    AssertEquals(MLSend(DataWithoutNull("Man"), "base64"), StringWithoutNull("TWFu"), "Data base64 encodes whole groups of three bytes");
+    AssertEquals(MLSend(DataWithoutNull("Ma"), "base64"), StringWithoutNull("TWE="), "Data base64 pads two trailing bytes");
+    AssertEquals(MLSend(DataWithoutNull("M"), "base64"), StringWithoutNull("TQ=="), "Data base64 pads one trailing byte");
+    AssertEquals(MLSend(DataWithoutNull(""), "base64"), StringWithoutNull(""), "Data base64 encodes empty data as an empty string");
+    AssertEquals(MLSend(DataWithoutNull("Man"), "as-string"), StringWithoutNull("TWFu"), "Data as-string returns the Base64 encoding");
+
+    AssertEquals(MLSend(MLData, "decode-base64*", MLString("TWE=")), DataWithoutNull("Ma"), "Data decode-base64* decodes padded strings");
+    AssertRaises("Data decode-base64* raises an exception for characters outside of the alphabet") MLSend(MLData, "decode-base64*", StringWithoutNull("TW!u"));
+    AssertRaises("Data decode-base64* raises an exception for a length that isn't a multiple of 4") MLSend(MLData, "decode-base64*", StringWithoutNull("TWF"));
+
+    // Large enough for the vectorised kernels, at every length of the tail:
+    char bytes[1000];
+    for (int i = 0; i < 1000; i += 1) bytes[i] = (char)(i * 7 + i / 13);
+
+    int mismatches = 0;
+    for (int count = 900; count < 1000; count += 1) {
+        MLCollect {
+            MLVariable data = MLCollectBlockAdd(MLDataMake(count, bytes));
+            MLVariable string = MLSend(data, "base64");
+            if (MLSend(MLSend(MLData, "decode-base64*", string), "equals*", data) == MLNo) mismatches += 1;
+        }
+    }
+    AssertEquals(MLNumber(mismatches), MLNumber(0), "Data base64 and decode-base64* round-trip large data");
+
+    char characters[128];
+    memset(characters, 'A', sizeof(characters));
+    characters[70] = '-';
+    AssertRaises("Data decode-base64* raises an exception for invalid characters in long strings") MLSend(MLData, "decode-base64*", MLCollectBlockAdd(MLStringMake(128, characters)));
+}
+
+static void TestDataHex() {
+    AssertEquals(MLSend(DataWithoutNull("\x01\xAB\xff"), "hex"), StringWithoutNull("01abff"), "Data hex encodes bytes as lowercase digits");
+    AssertEquals(MLSend(MLData, "decode-hex*", StringWithoutNull("01ABff")), DataWithoutNull("\x01\xAB\xff"), "Data decode-hex* accepts upper and lowercase digits");
+    AssertRaises("Data decode-hex* raises an exception for characters that aren't hex digits") MLSend(MLData, "decode-hex*", StringWithoutNull("0g"));
+    AssertRaises("Data decode-hex* raises an exception for an odd length") MLSend(MLData, "decode-hex*", StringWithoutNull("012"));
+
+    char bytes[1000];
+    for (int i = 0; i < 1000; i += 1) bytes[i] = (char)(i * 13 + 5);
+
+    MLVariable data = MLCollectBlockAdd(MLDataMake(1000, bytes));
+    MLVariable string = MLSend(data, "hex");
+    AssertEquals(MLSend(MLData, "decode-hex*", string), data, "Data hex and decode-hex* round-trip large data");
+
+    char characters[64];
+    memset(characters, 'a', sizeof(characters));
+    characters[40] = 'x';
+    AssertRaises("Data decode-hex* raises an exception for invalid characters in long strings") MLSend(MLData, "decode-hex*", MLCollectBlockAdd(MLStringMake(64, characters)));
+}
+
+static void TestDataEnumerate() {
+    MLVariable data = MLData("\x01\x02\xff");
+    MLInteger sum = 0;
+    MLInteger count = 0;
+
+    MLForEach(number, data) {
+        sum += MLIntegerFrom(number);
+        count += 1;
+    }
+
+    AssertEquals(MLNumber(count), MLNumber(4), "Data enumerate* enumerates all bytes");
+    AssertEquals(MLNumber(sum), MLNumber(1 + 2 + 255), "Data enumerate* enumerates the bytes as numbers");
+}
+
+static void TestDataCopy() {
+    MLVariable data = MLSend(MLData, "create", MLString("mutable"), MLYes);
+    MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(0), DataWithoutNull("0123456789abcdef0123456789abcdef"));
+    MLVariable copy = MLSend(MLSend(data, "copy"), "collect");
+    AssertNo(MLSend(copy, "is-mutable"), "Data copy of mutable data returns immutable data");
+    AssertEquals(copy, data, "Data copy has the same bytes");
+    MLSend(data, "replace-at*count*with*", MLNumber(0), MLNumber(32), DataWithoutNull("replaced"));
+    AssertEquals(copy, DataWithoutNull("0123456789abcdef0123456789abcdef"), "Data copy keeps its bytes when the original changes");
+}
+
 static void TestData() {
     TestDataEquals();
+    TestDataReplaceAtCountWith();
+    TestDataAtCount();
+    TestDataAtCountOfMutable();
+    TestDataMap();
+    TestDataBase64();
+    TestDataHex();
+    TestDataEnumerate();
+    TestDataCopy();
     // TODO: add more tests.
 }
 
@@ -342,16 +618,330 @@ static void TestArrayReplaceAtCountWith() {
 
     AssertEquals(MLSend(array1, "replace-at*count*with*", MLNumber(1), MLNumber(2), MLArray(MLNumber(5), MLNumber(6), MLNumber(7))), MLArray(MLNumber(1), MLNumber(5), MLNumber(6), MLNumber(7), MLNumber(4)), "Array replace-at*count*with* replaces `count` objects starting at `index` with `objects`");
     AssertEquals(MLSend(array2, "replace-at*count*with*", MLNumber(0), MLNumber(0), MLArray()), MLArray(), "Array replace-at*count*with* doesn't change the array when `count` is 0 and `index` is valid");
+    AssertEquals(MLSend(array3, "replace-at*count*with*", MLNumber(1), MLNumber(1), array3), MLArray(MLNumber(3), MLNumber(3), MLNumber(4), MLNumber(5), MLNumber(5)), "Array replace-at*count*with* can replace a range with the array itself");
+    AssertEquals(MLSend(array4, "replace-at*count*with*", MLNumber(1), MLNumber(10), MLArray()), MLArray(MLNumber(6)), "Array replace-at*count*with* removes objects when `objects` is empty");
+
+    MLVariable large = MLArray(MLMore);
+    MLVariable chunk = MLArray(MLMore);
+    for (int i = 0; i < 1000; i += 1) MLSend(chunk, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(i)));
+    for (int i = 0; i < 100; i += 1) MLSend(large, "replace-at*count*with*", MLNumber(0), MLNumber(0), chunk);
+    AssertEquals(MLSend(large, "count"), MLNumber(100000), "Array replace-at*count*with* inserts whole arrays in bulk");
+    AssertEquals(MLSend(large, "at*", MLNumber(99999)), MLNumber(999), "Array replace-at*count*with* keeps objects in order when inserting in bulk");
     // TODO: check that non-mutable arrays raise an exception when trying to mutate.
 }
 
+static void TestArrayFront() {
+    MLVariable queue = MLArray(MLMore);
+    long expected = 0;
+    bool inOrder = true;
+
+    // Push at the back, pop at the front, with the queue growing over time:
+    for (long i = 0; i < 30000; i += 1) MLCollect {
+        MLVariable count = MLSend(queue, "count");
+        MLSend(queue, "replace-at*count*with*", count, MLNumber(0), MLArray(MLNumber(i)));
+        if (i % 3 == 0) continue;
+        inOrder = inOrder && MLIntegerFrom(MLSend(queue, "at*", MLNumber(0))) == expected;
+        MLSend(queue, "replace-at*count*with*", MLNumber(0), MLNumber(1), MLArray());
+        expected += 1;
+    }
+
+    AssertYes(MLBoolean(inOrder), "Array replace-at*count*with* removes objects at the front in order");
+    AssertEquals(MLSend(queue, "count"), MLNumber(10000), "Array replace-at*count*with* keeps the count when removing at the front");
+    AssertEquals(MLSend(queue, "at*", MLNumber(9999)), MLNumber(29999), "Array replace-at*count*with* keeps the last object when removing at the front");
+
+    MLVariable stack = MLArray(MLMore);
+    for (long i = 0; i < 20000; i += 1) MLCollect MLSend(stack, "replace-at*count*with*", MLNumber(0), MLNumber(0), MLArray(MLNumber(i)));
+    AssertEquals(MLSend(stack, "at*", MLNumber(0)), MLNumber(19999), "Array replace-at*count*with* inserts objects at the front");
+    AssertEquals(MLSend(stack, "at*", MLNumber(19999)), MLNumber(0), "Array replace-at*count*with* keeps objects inserted at the front in order");
+
+    MLSend(stack, "replace-at*count*with*", MLNumber(1), MLNumber(2), MLArray(MLNumber(-1), MLNumber(-2), MLNumber(-3)));
+    AssertEquals(MLSend(stack, "at*", MLNumber(3)), MLNumber(-3), "Array replace-at*count*with* replaces objects near the front");
+    AssertEquals(MLSend(stack, "at*", MLNumber(4)), MLNumber(19996), "Array replace-at*count*with* keeps the objects after those replaced near the front");
+    AssertEquals(MLSend(stack, "count"), MLNumber(20001), "Array replace-at*count*with* updates the count when replacing near the front");
+}
+
+static long TestArrayReleasesCount = 0;
+
+static MLVariable TestArrayCountRelease(MLVariable self, MLVariable super, MLVariable command, MLVariable options, ...) {
+    TestArrayReleasesCount += 1;
+    return MLSuper(self, "release");
+}
+
+static void TestArrayReleaseOverridden() {
+    MLVariable object = MLSend(MLObject, "create");
+    MLSend(object, "add-method*block*", MLString("release"), MLBlock(TestArrayCountRelease));
+
+    TestArrayReleasesCount = 0;
+    MLCollect { MLArray(MLNumber(1), object, object, MLNumber(2)); }
+    AssertEquals(MLNumber(TestArrayReleasesCount), MLNumber(2), "Array destroy sends release to objects that override it");
+}
+
+static void TestArrayEnumerate() {
+    MLVariable array = MLArray(MLNumber(1), MLNumber(2), MLNumber(3), MLMore);
+    MLVariable empty = MLArray(MLMore);
+    MLInteger sum = 0;
+    MLInteger pairs = 0;
+
+    MLForEach(number, array) sum += MLIntegerFrom(number);
+    AssertEquals(MLNumber(sum), MLNumber(6), "Array enumerate* enumerates all objects in order");
+
+    MLForEach(number, array) {
+        MLForEach(other, array) {
+            if (other == number) break;
+            pairs += 1;
+        }
+    }
+    AssertEquals(MLNumber(pairs), MLNumber(3), "MLForEach can be nested and left with break");
+
+    pairs = 0;
+    MLForEach(number, array) MLForEach(other, array) pairs += 1;
+    AssertEquals(MLNumber(pairs), MLNumber(9), "MLForEach can be nested on one line");
+
+    MLForEach(object, empty) sum += 1;
+    AssertEquals(MLNumber(sum), MLNumber(6), "Array enumerate* enumerates nothing for an empty array");
+
+    AssertRaises("Array enumerate* raises an exception when the array is mutated while being enumerated") {
+        MLForEach(number, array) MLSend(array, "replace-at*count*with*", MLNumber(0), MLNumber(0), MLArray(MLNumber(0)));
+    }
+}
+
+static MLVariable TestArraySquare(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    return MLNumber(MLDecimalFrom(number) * MLDecimalFrom(number));
+}
+
+static MLVariable TestArrayIsEven(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    return MLBoolean(MLIntegerFrom(number) % 2 == 0);
+}
+
+static MLVariable TestArrayAdd(MLVariable block, MLVariable super, MLVariable command, MLVariable number1, MLVariable number2, MLVariable options, ...) {
+    return MLNumber(MLDecimalFrom(number1) + MLDecimalFrom(number2));
+}
+
+static MLVariable TestArrayJoin(MLVariable block, MLVariable super, MLVariable command, MLVariable string1, MLVariable string2, MLVariable options, ...) {
+    MLVariable builder = MLSend(MLStringBuilder, "create");
+    MLSend(builder, "append*", string1);
+    MLSend(builder, "append*", string2);
+    return MLSend(builder, "freeze");
+}
+
+static long TestArrayEachSum = 0;
+
+static MLVariable TestArrayAccumulate(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    __atomic_add_fetch(&TestArrayEachSum, MLIntegerFrom(number), __ATOMIC_RELAXED);
+    return MLNull;
+}
+
+static MLVariable TestArrayFailAt5000(MLVariable block, MLVariable super, MLVariable command, MLVariable number, MLVariable options, ...) {
+    if (MLIntegerFrom(number) == 5000) MLSend(number, "fail*", MLString("TestException | Failed at 5000"));
+    return number;
+}
+
+static void TestArrayMapFilterReduce() {
+    long const count = 10000;
+    MLVariable numbers = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(count));
+    MLVariable strings = MLArray(MLMore);
+    for (long i = 0; i < count; i += 1) MLSend(numbers, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(i)));
+    for (long i = 0; i < 3000; i += 1) MLSend(strings, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(StringWithoutNull("ab")));
+
+    MLVariable squares = MLSend(numbers, "map*", MLBlock(TestArraySquare));
+    AssertEquals(MLSend(squares, "count"), MLNumber(count), "Array map* returns an array with one result per object");
+    AssertEquals(MLSend(squares, "at*", MLNumber(9999)), MLNumber(9999.0 * 9999.0), "Array map* keeps the results in order");
+    AssertEquals(MLSend(MLArray(MLNumber(3)), "map*", MLBlock(TestArraySquare)), MLArray(MLNumber(9)), "Array map* maps small arrays");
+
+    MLVariable evens = MLSend(numbers, "filter*", MLBlock(TestArrayIsEven));
+    AssertEquals(MLSend(evens, "count"), MLNumber(count / 2), "Array filter* keeps the objects for which the block returns MLYes");
+    AssertEquals(MLSend(evens, "at*", MLNumber(4999)), MLNumber(9998), "Array filter* keeps the objects in order");
+
+    AssertEquals(MLSend(numbers, "reduce*with*", MLNumber(0), MLBlock(TestArrayAdd)), MLNumber(count * (count - 1) / 2), "Array reduce*with* combines all objects with the block");
+    AssertEquals(MLSend(MLArray(), "reduce*with*", MLNumber(7), MLBlock(TestArrayAdd)), MLNumber(7), "Array reduce*with* returns the initial object for an empty array");
+    AssertEquals(MLSend(MLSend(strings, "reduce*with*", StringWithoutNull(">"), MLBlock(TestArrayJoin)), "length"), MLNumber(6001), "Array reduce*with* combines the chunks in order");
+
+    TestArrayEachSum = 0;
+    MLSend(numbers, "each*", MLBlock(TestArrayAccumulate));
+    AssertEquals(MLNumber(TestArrayEachSum), MLNumber(count * (count - 1) / 2), "Array each* runs the block for every object");
+
+    AssertRaises("Array map* raises the exception raised by the block") MLSend(numbers, "map*", MLBlock(TestArrayFailAt5000));
+    AssertRaises("Array map* raises an exception when not given a block") MLSend(numbers, "map*", MLNumber(1));
+}
+
+static MLVariable TestArrayCompareDigits(MLVariable block, MLVariable super, MLVariable command, MLVariable number1, MLVariable number2, MLVariable options, ...) {
+    return MLNumber(MLIntegerFrom(number1) % 10 - MLIntegerFrom(number2) % 10);
+}
+
+static MLVariable TestArrayFailToCompare(MLVariable block, MLVariable super, MLVariable command, MLVariable number1, MLVariable number2, MLVariable options, ...) {
+    return MLSend(number1, "fail*", MLString("TestException | Can't compare"));
+}
+
+static bool TestArrayIsSorted(MLVariable array, bool byDigits) {
+    long const count = MLIntegerFrom(MLSend(array, "count"));
+    for (long i = 1; i < count; i += 1) {
+        long const number1 = MLIntegerFrom(MLSend(array, "at*", MLNumber(i - 1)));
+        long const number2 = MLIntegerFrom(MLSend(array, "at*", MLNumber(i)));
+        if (byDigits && (number1 % 10 > number2 % 10 || (number1 % 10 == number2 % 10 && number1 > number2))) return false;
+        if (!byDigits && number1 > number2) return false;
+    }
+    return true;
+}
+
+static void TestArraySort() {
+    long const count = 20000;
+    MLVariable shuffled = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(count));
+    MLVariable reversed = MLSend(MLArray, "create", MLString("mutable"), MLYes, MLString("capacity"), MLNumber(count));
+    unsigned long seed = 1;
+    for (long i = 0; i < count; i += 1) MLCollect {
+        seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+        MLSend(shuffled, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber((seed >> 33) % count)));
+        MLSend(reversed, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(count - i)));
+    }
+
+    MLVariable sorted = MLSend(shuffled, "sort");
+    AssertEquals(MLSend(sorted, "count"), MLNumber(count), "Array sort returns an array with all objects");
+    AssertYes(MLBoolean(TestArrayIsSorted(sorted, false)), "Array sort sorts numbers");
+    MLVariable sum = MLSend(shuffled, "reduce*with*", MLNumber(0), MLBlock(TestArrayAdd));
+    AssertEquals(MLSend(sorted, "reduce*with*", MLNumber(0), MLBlock(TestArrayAdd)), sum, "Array sort keeps every object");
+    AssertYes(MLBoolean(TestArrayIsSorted(MLSend(reversed, "sort"), false)), "Array sort sorts descending runs");
+    AssertYes(MLBoolean(TestArrayIsSorted(MLSend(sorted, "sort"), false)), "Array sort sorts sorted arrays");
+    AssertYes(MLBoolean(TestArrayIsSorted(MLSend(sorted, "sort-by*", MLBlock(TestArrayCompareDigits)), true)), "Array sort-by* sorts large arrays stably");
+
+    AssertEquals(MLSend(MLArray(StringWithoutNull("pear"), StringWithoutNull("apple pie"), StringWithoutNull("fig"), StringWithoutNull("apple")), "sort"), MLArray(StringWithoutNull("apple"), StringWithoutNull("apple pie"), StringWithoutNull("fig"), StringWithoutNull("pear")), "Array sort sorts strings");
+    AssertEquals(MLSend(MLArray(MLYes, MLNo, MLYes), "sort"), MLArray(MLNo, MLYes, MLYes), "Array sort sorts other objects with compare*");
+    AssertEquals(MLSend(MLArray(MLNumber(21), MLNumber(3), MLNumber(11), MLNumber(1)), "sort-by*", MLBlock(TestArrayCompareDigits)), MLArray(MLNumber(21), MLNumber(11), MLNumber(1), MLNumber(3)), "Array sort-by* keeps equal objects in order");
+    AssertEquals(MLSend(MLArray(), "sort"), MLArray(), "Array sort sorts empty arrays");
+
+    AssertRaises("Array sort-by* raises the exception raised by the block") MLSend(shuffled, "sort-by*", MLBlock(TestArrayFailToCompare));
+    AssertRaises("Array sort-by* raises an exception when not given a block") MLSend(shuffled, "sort-by*", MLNumber(1));
+}
+
+static void TestArrayCopy() {
+    MLVariable array = MLArray(MLNumber(1), MLNumber(2), MLMore);
+    MLVariable copy = MLSend(MLSend(array, "copy"), "collect");
+    MLVariable mutableCopy = MLSend(MLSend(array, "copy", MLString("mutable"), MLYes), "collect");
+    AssertNo(MLSend(copy, "is-mutable"), "Array copy of a mutable array returns an immutable array");
+    AssertYes(MLSend(mutableCopy, "is-mutable"), "Array copy returns a mutable array when asked to");
+    AssertEquals(copy, array, "Array copy has the same objects");
+
+    MLSend(array, "replace-at*count*with*", MLNumber(0), MLNumber(1), MLArray(MLNumber(3)));
+    MLSend(mutableCopy, "replace-at*count*with*", MLNumber(2), MLNumber(0), MLArray(MLNumber(4)));
+    AssertEquals(array, MLArray(MLNumber(3), MLNumber(2)), "Array replace-at*count*with* changes the original of a copy");
+    AssertEquals(copy, MLArray(MLNumber(1), MLNumber(2)), "Array copy keeps its objects when the original changes");
+    AssertEquals(mutableCopy, MLArray(MLNumber(1), MLNumber(2), MLNumber(4)), "Array copy changes on its own when mutable");
+
+    MLVariable immutable = MLArray(MLNumber(1));
+    AssertIdentical(MLSend(MLSend(immutable, "copy"), "collect"), immutable, "Array copy of an immutable array returns the same instance");
+}
+
+static void TestArrayHash() {
+    MLVariable array1 = MLArray(MLNumber(1), StringWithoutNull("two"), MLArray(MLNumber(3)));
+    MLVariable array2 = MLArray(MLNumber(1), StringWithoutNull("two"), MLArray(MLNumber(3)), MLMore);
+    MLVariable array3 = MLArray(StringWithoutNull("two"), MLNumber(1), MLArray(MLNumber(3)));
+    AssertEquals(MLSend(array1, "hash"), MLSend(array2, "hash"), "Array hash is the same for equal arrays");
+    AssertNotEqual(MLSend(array1, "hash"), MLSend(array3, "hash"), "Array hash depends on the order of the objects");
+    AssertNotEqual(array1, array3, "Array equals* returns MLNo for arrays with the same objects in another order");
+
+    MLVariable dictionary = MLDictionary(array1, MLYes, MLMore);
+    AssertEquals(MLSend(dictionary, "get*", array2), MLYes, "Array hash lets arrays be used as dictionary keys");
+    AssertNull(MLSend(dictionary, "get*", array3), "Array hash lets dictionaries tell array keys apart");
+
+    MLSend(array2, "replace-at*count*with*", MLNumber(0), MLNumber(1), MLArray(MLNumber(4)));
+    AssertNotEqual(MLSend(array1, "hash"), MLSend(array2, "hash"), "Array replace-at*count*with* clears the cached hash");
+    AssertNotEqual(array1, array2, "Array equals* returns MLNo after an array changed");
+    MLSend(array2, "replace-at*count*with*", MLNumber(0), MLNumber(1), MLArray(MLNumber(1)));
+    AssertEquals(array1, array2, "Array equals* returns MLYes once arrays are equal again");
+}
+
 static void TestArray() {
     TestArrayEquals();
     TestArrayCount();
     TestArrayReplaceAtCountWith();
+    TestArrayFront();
+    TestArrayReleaseOverridden();
+    TestArrayHash();
+    TestArrayEnumerate();
+    TestArrayMapFilterReduce();
+    TestArraySort();
+    TestArrayCopy();
     // TODO: add more tests.
 }
 
+// --------------------------------------------------- Number Array Tests ------
+
+static MLVariable TestNumberArrayMake(bool integer, MLVariable numbers) {
+    MLVariable array = MLSend(MLNumberArray, "create", MLString("mutable"), MLYes, MLString("integer"), MLBoolean(integer));
+    return MLSend(array, "replace-at*count*with*", MLNumber(0), MLNumber(0), numbers);
+}
+
+static void TestNumberArrayReplaceAtCountWith() {
+    MLVariable array = TestNumberArrayMake(false, MLArray(MLNumber(1), MLNumber(2), MLNumber(3), MLNumber(4), MLMore));
+    AssertEquals(MLSend(array, "count"), MLNumber(4), "NumberArray replace-at*count*with* packs the numbers of an array");
+    AssertEquals(MLSend(array, "at*", MLNumber(2)), MLNumber(3), "NumberArray at* boxes the number at the given index");
+
+    MLSend(array, "replace-at*count*with*", MLNumber(1), MLNumber(2), TestNumberArrayMake(false, MLArray(MLNumber(7), MLNumber(8), MLNumber(9), MLMore)));
+    AssertEquals(array, TestNumberArrayMake(false, MLArray(MLNumber(1), MLNumber(7), MLNumber(8), MLNumber(9), MLNumber(4), MLMore)), "NumberArray replace-at*count*with* replaces `count` numbers starting at `index` with `numbers`");
+
+    MLSend(array, "replace-at*count*with*", MLNumber(0), MLNumber(0), array);
+    AssertEquals(MLSend(array, "count"), MLNumber(10), "NumberArray replace-at*count*with* can insert the array into itself");
+
+    MLVariable integers = TestNumberArrayMake(true, MLArray(MLNumber(1.75), MLNumber(-2.5), MLMore));
+    AssertEquals(MLSend(integers, "at*", MLNumber(0)), MLNumber(1), "NumberArray replace-at*count*with* truncates decimals stored into an integer array");
+    AssertNo(MLSend(integers, "equals*", TestNumberArrayMake(false, MLArray(MLNumber(1), MLNumber(-2), MLMore))), "NumberArray equals* returns MLNo for arrays of different kinds");
+
+    AssertRaises("NumberArray at* raises an exception for an index out of range") MLSend(array, "at*", MLNumber(10));
+    AssertRaises("NumberArray replace-at*count*with* raises an exception when sent to an immutable array") MLSend(MLSend(MLNumberArray, "create"), "replace-at*count*with*", MLNumber(0), MLNumber(0), MLArray(MLNumber(1), MLMore));
+}
+
+static void TestNumberArrayAsString() {
+    AssertEquals(MLSend(MLNumberArray, "as-string"), MLString("NumberArray"), "NumberArray as-string returns 'NumberArray' for NumberArray");
+    AssertEquals(MLSend(TestNumberArrayMake(false, MLArray(MLMore)), "as-string"), StringWithoutNull("[]"), "NumberArray as-string returns '[]' for an empty array");
+    AssertEquals(MLSend(TestNumberArrayMake(false, MLArray(MLNumber(1), MLNumber(2.5), MLNumber(-3), MLMore)), "as-string"), StringWithoutNull("[1, 2.5, -3]"), "NumberArray as-string formats the numbers of a decimal array");
+    AssertEquals(MLSend(TestNumberArrayMake(true, MLArray(MLNumber(7), MLNumber(-42), MLMore)), "as-string"), StringWithoutNull("[7, -42]"), "NumberArray as-string formats the numbers of an integer array");
+}
+
+static void TestNumberArrayHash() {
+    MLVariable array1 = TestNumberArrayMake(false, MLArray(MLNumber(1), MLNumber(2.5), MLMore));
+    MLVariable array2 = TestNumberArrayMake(false, MLArray(MLNumber(1), MLNumber(2.5), MLMore));
+    MLDecimal const hash = MLDecimalFrom(MLSend(array1, "hash"));
+    AssertEquals(MLSend(array1, "hash"), MLSend(array2, "hash"), "NumberArray hash is the same for equal arrays");
+    AssertYes(MLBoolean(hash >= 0 && hash < 9007199254740992.0 && hash == (MLDecimal)(MLNatural)hash), "NumberArray hash is an integer that a number holds exactly");
+}
+
+static void TestNumberArrayOperations() {
+    long const count = 1003;
+    MLVariable decimals = TestNumberArrayMake(false, MLArray(MLMore));
+    MLVariable integers = TestNumberArrayMake(true, MLArray(MLMore));
+    MLVariable ones = TestNumberArrayMake(true, MLArray(MLMore));
+
+    for (long i = 0; i < count; i += 1) {
+        MLVariable numbers = MLArray(MLNumber(i % 2 == 0 ? i : -i), MLMore);
+        MLSend(decimals, "replace-at*count*with*", MLNumber(i), MLNumber(0), numbers);
+        MLSend(integers, "replace-at*count*with*", MLNumber(i), MLNumber(0), numbers);
+        MLSend(ones, "replace-at*count*with*", MLNumber(i), MLNumber(0), MLArray(MLNumber(1), MLMore));
+    }
+
+    AssertEquals(MLSend(decimals, "sum"), MLNumber(501), "NumberArray sum adds up all decimals");
+    AssertEquals(MLSend(integers, "sum"), MLNumber(501), "NumberArray sum adds up all integers");
+    AssertEquals(MLSend(decimals, "min"), MLNumber(-1001), "NumberArray min returns the smallest decimal");
+    AssertEquals(MLSend(integers, "max"), MLNumber(1002), "NumberArray max returns the largest integer");
+    AssertIdentical(MLSend(TestNumberArrayMake(false, MLArray(MLMore)), "min"), MLNull, "NumberArray min returns null for an empty array");
+    AssertEquals(MLSend(integers, "dot*", ones), MLNumber(501), "NumberArray dot* returns the dot product of two arrays");
+
+    MLSend(integers, "add*", ones);
+    AssertEquals(MLSend(integers, "sum"), MLNumber(501 + count), "NumberArray add* adds another array element-wise");
+
+    MLSend(decimals, "scale*", MLNumber(0.5));
+    AssertEquals(MLSend(decimals, "max"), MLNumber(501), "NumberArray scale* multiplies every number by a factor");
+    AssertEquals(MLSend(decimals, "at*", MLNumber(1001)), MLNumber(-500.5), "NumberArray scale* multiplies numbers past the last full vector too");
+
+    AssertRaises("NumberArray dot* raises an exception for an array of a different count") MLSend(decimals, "dot*", TestNumberArrayMake(false, MLArray(MLNumber(1), MLMore)));
+    AssertRaises("NumberArray add* raises an exception for an array of a different kind") MLSend(decimals, "add*", integers);
+}
+
+static void TestNumberArray() {
+    TestNumberArrayReplaceAtCountWith();
+    TestNumberArrayAsString();
+    TestNumberArrayHash();
+    TestNumberArrayOperations();
+}
+
 // --------------------------------------------------------- String Tests ------
 
 static void TestStringEquals() {
@@ -369,11 +959,221 @@ static void TestStringEquals() {
     AssertNo(MLSend(string1, "equals*", MLNumber(9)), "String equals* returns MLNo when comparing a string object to a number (here: 9)");
 }
 
+static void TestStringCompare() {
+    MLVariable string = StringWithoutNull("abcdef");
+    MLVariable prefix = MLSend(string, "at*count*", MLNumber(0), MLNumber(3));
+    AssertEquals(MLSend(StringWithoutNull("abc"), "compare*", StringWithoutNull("abc")), MLNumber(0), "String compare* returns 0 when comparing equal strings");
+    AssertEquals(MLSend(StringWithoutNull("abc"), "compare*", StringWithoutNull("abd")), MLNumber(-1), "String compare* returns -1 when the first differing character is smaller");
+    AssertEquals(MLSend(StringWithoutNull("abd"), "compare*", StringWithoutNull("abc")), MLNumber(+1), "String compare* returns +1 when the first differing character is larger");
+    AssertEquals(MLSend(StringWithoutNull("abc"), "compare*", string), MLNumber(-1), "String compare* returns -1 when the string begins the other one");
+    AssertEquals(MLSend(string, "compare*", StringWithoutNull("abc")), MLNumber(+1), "String compare* returns +1 when the other string begins the string");
+    AssertEquals(MLSend(prefix, "compare*", string), MLNumber(-1), "String compare* returns -1 when comparing a view to the string it begins");
+    AssertNull(MLSend(string, "compare*", MLNumber(1)), "String compare* returns MLNull when comparing a string to a number");
+}
+
+static void* TestStringInternThread(void* strings) {
+    char characters[32];
+
+    for (int i = 0; i < 20000; i += 1) {
+        int const length = snprintf(characters, sizeof(characters), "intern-%d", i % 500);
+        MLVariable string = MLStringMake(length, characters);
+
+        if (i < 500) ((MLVariable*)strings)[i] = string;
+        else MLSend(string, "release");
+    }
+
+    return MLZero;
+}
+
+static void TestStringInternConcurrently() {
+    MLVariable strings[4][500];
+    pthread_t threads[4];
+
+    for (int i = 0; i < 4; i += 1) pthread_create(&threads[i], NULL, TestStringInternThread, strings[i]);
+    for (int i = 0; i < 4; i += 1) pthread_join(threads[i], NULL);
+
+    bool identical = true;
+    for (int i = 0; i < 500; i += 1) identical = identical && strings[0][i] == strings[1][i] && strings[0][i] == strings[2][i] && strings[0][i] == strings[3][i];
+    AssertYes(MLBoolean(identical), "Strings interned concurrently by several threads are identical");
+
+    for (int i = 0; i < 4; i += 1) for (int j = 0; j < 500; j += 1) MLSend(strings[i][j], "release");
+}
+
+static MLVariable TestStringConstantSite() {
+    return MLStringConstant("constant-first-used-concurrently");
+}
+
+static void* TestStringConstantThread(void* constants) {
+    for (int i = 0; i < 1000; i += 1) ((MLVariable*)constants)[i] = TestStringConstantSite();
+    return MLZero;
+}
+
+static void TestStringConstant() {
+    MLVariable constant = MLStringConstant("is-kind-of*");
+    AssertIdentical(constant, MLString("is-kind-of*"), "MLStringConstant resolves to the string interned before it");
+    AssertIdentical(MLStringConstant("interned-by-a-constant"), MLString("interned-by-a-constant"), "MLStringConstant is the string interned when it is used first");
+    AssertEquals(MLSend(constant, "length"), MLNumber(sizeof("is-kind-of*")), "MLStringConstant includes the trailing '\\0' like MLString");
+
+    MLSend(MLStringConstant("interned-by-a-constant"), "release");
+    AssertIdentical(MLStringConstant("interned-by-a-constant"), MLString("interned-by-a-constant"), "MLStringConstant strings are eternal");
+
+    MLVariable constants[4][1000];
+    pthread_t threads[4];
+
+    for (int i = 0; i < 4; i += 1) pthread_create(&threads[i], NULL, TestStringConstantThread, constants[i]);
+    for (int i = 0; i < 4; i += 1) pthread_join(threads[i], NULL);
+
+    bool identical = true;
+    for (int i = 0; i < 4; i += 1) for (int j = 0; j < 1000; j += 1) identical = identical && constants[i][j] == constants[0][0];
+    AssertYes(MLBoolean(identical), "MLStringConstant resolves to the same string when first used by several threads");
+}
+
+static void TestStringReplaceAtCountWith() {
+    MLVariable string = MLSend(MLString, "create", MLString("mutable"), MLYes);
+    MLSend(string, "replace-at*count*with*", MLNumber(0), MLNumber(0), StringWithoutNull("hello world"));
+    AssertEquals(string, StringWithoutNull("hello world"), "String replace-at*count*with* inserts characters into an empty string");
+    AssertEquals(MLSend(string, "hash"), MLSend(StringWithoutNull("hello world"), "hash"), "String hash is computed from the characters of a mutable string");
+
+    MLSend(string, "replace-at*count*with*", MLNumber(6), MLNumber(100), StringWithoutNull("there"));
+    AssertEquals(string, StringWithoutNull("hello there"), "String replace-at*count*with* replaces a range of characters, clamping the count");
+    AssertEquals(MLSend(string, "hash"), MLSend(StringWithoutNull("hello there"), "hash"), "String replace-at*count*with* invalidates the cached hash");
+
+    MLSend(string, "replace-at*count*with*", MLNumber(5), MLNumber(0), string);
+    AssertEquals(string, StringWithoutNull("hellohello there there"), "String replace-at*count*with* can insert the string into itself");
+
+    AssertRaises("String replace-at*count*with* raises an exception when sent to an immutable string") MLSend(MLString("12345"), "replace-at*count*with*", MLNumber(0), MLNumber(1), MLString("x"));
+}
+
+static void TestStringRope() {
+    static char expected[40000];
+    MLInteger expectedLength = 0;
+    MLVariable string = MLSend(MLString, "create", MLString("mutable"), MLYes);
+    MLVariable pieces[] = {StringWithoutNull("lorem "), StringWithoutNull("ipsum dolor "), StringWithoutNull("sit")};
+    char const* characters[] = {"lorem ", "ipsum dolor ", "sit"};
+    unsigned seed = 42;
+
+    // Splice pieces in at pseudo random positions, sometimes replacing a few characters:
+    for (int i = 0; i < 3000; i += 1) {
+        seed = seed * 1103515245 + 12345;
+        MLInteger const index = expectedLength == 0 ? 0 : (seed >> 8) % expectedLength;
+        MLInteger const remaining = expectedLength - index;
+        MLInteger const count = (MLInteger)(seed >> 4) % 4 < remaining ? (MLInteger)(seed >> 4) % 4 : remaining;
+        MLInteger const length = strlen(characters[i % 3]);
+
+        memmove(expected + index + length, expected + index + count, expectedLength - index - count);
+        memcpy(expected + index, characters[i % 3], length);
+        expectedLength += length - count;
+
+        MLSend(string, "replace-at*count*with*", MLNumber(index), MLNumber(count), pieces[i % 3]);
+    }
+
+    AssertEquals(MLSend(string, "length"), MLNumber(expectedLength), "String replace-at*count*with* keeps the length of a large string up to date");
+    AssertEquals(MLSend(string, "at*count*", MLNumber(1000), MLNumber(50)), MLCollectBlockAdd(MLStringMake(50, expected + 1000)), "String at*count* returns the characters in the given range of a large string");
+    AssertEquals(string, MLCollectBlockAdd(MLStringMake(expectedLength, expected)), "String replace-at*count*with* splices characters into a large string");
+
+    // Edit again after the comparison flattened the string:
+    MLSend(string, "replace-at*count*with*", MLNumber(0), MLNumber(expectedLength - 3), StringWithoutNull("ab"));
+    AssertEquals(string, MLCollectBlockAdd(MLStringMake(5, (char[]){'a', 'b', expected[expectedLength - 3], expected[expectedLength - 2], expected[expectedLength - 1]})), "String replace-at*count*with* works on a large string after it was flattened");
+}
+
+static void TestStringAtCount() {
+    MLVariable string = StringWithoutNull("hello world");
+    AssertEquals(MLSend(string, "at*count*", MLNumber(6), MLNumber(5)), StringWithoutNull("world"), "String at*count* returns the characters in the given range");
+    AssertEquals(MLSend(string, "at*count*", MLNumber(6), MLNumber(100)), StringWithoutNull("world"), "String at*count* clamps the count to the end of the string");
+    AssertRaises("String at*count* raises an exception when the index is out of range") MLSend(string, "at*count*", MLNumber(12), MLNumber(1));
+}
+
+static void TestStringAtCountLarge() {
+    char characters[10000];
+    for (int i = 0; i < 10000; i += 1) characters[i] = 'a' + i % 26;
+
+    MLVariable string = MLCollectBlockAdd(MLStringMake(10000, characters));
+    MLVariable slice = MLSend(string, "at*count*", MLNumber(100), MLNumber(5000));
+    MLVariable sliceOfSlice = MLSend(slice, "at*count*", MLNumber(1000), MLNumber(3000));
+    AssertEquals(slice, MLCollectBlockAdd(MLStringMake(5000, characters + 100)), "String at*count* returns a large range of a large string");
+    AssertEquals(sliceOfSlice, MLCollectBlockAdd(MLStringMake(3000, characters + 1100)), "String at*count* returns a large range of a slice");
+    AssertEquals(MLSend(slice, "hash"), MLSend(MLCollectBlockAdd(MLStringMake(5000, characters + 100)), "hash"), "String hash of a slice equals the hash of an equal string");
+    AssertEquals(MLSend(string, "at*count*", MLNumber(0), MLNumber(5)), StringWithoutNull("abcde"), "String at*count* returns short ranges interned");
+    AssertYes(MLBoolean(MLSend(string, "at*count*", MLNumber(0), MLNumber(5)) == StringWithoutNull("abcde")), "String at*count* returns short ranges interned (here: identical)");
+
+    MLVariable mutable = MLSend(MLString, "create", MLString("mutable"), MLYes);
+    MLSend(mutable, "replace-at*count*with*", MLNumber(0), MLNumber(0), MLCollectBlockAdd(MLStringMake(3000, characters)));
+    MLVariable mutableSlice = MLSend(mutable, "at*count*", MLNumber(0), MLNumber(2500));
+    MLSend(mutable, "replace-at*count*with*", MLNumber(0), MLNumber(3000), StringWithoutNull("replaced"));
+    AssertEquals(mutableSlice, MLCollectBlockAdd(MLStringMake(2500, characters)), "String at*count* slices keep their characters when the parent changes");
+}
+
+static void TestStringHashLarge() {
+    char characters[4096];
+    memset(characters, 'x', sizeof(characters));
+
+    MLVariable string1 = MLCollectBlockAdd(MLStringMake(sizeof(characters), characters));
+    MLVariable string2 = MLCollectBlockAdd(MLStringMake(sizeof(characters), characters));
+    AssertEquals(MLSend(string1, "hash"), MLSend(string2, "hash"), "String hash is computed lazily for equal strings too large to be interned");
+    AssertYes(MLSend(string1, "equals*", string2), "String equals* returns MLYes for equal strings too large to be interned");
+}
+
+static void TestStringCopy() {
+    MLVariable string = MLSend(MLString, "create", MLString("mutable"), MLYes);
+    MLSend(string, "replace-at*count*with*", MLNumber(0), MLNumber(0), StringWithoutNull("copy on write"));
+    MLVariable copy = MLSend(MLSend(string, "copy"), "collect");
+    AssertNo(MLSend(copy, "is-mutable"), "String copy of a mutable string returns an immutable string");
+    MLSend(string, "replace-at*count*with*", MLNumber(0), MLNumber(4), StringWithoutNull("read"));
+    AssertEquals(copy, StringWithoutNull("copy on write"), "String copy keeps its characters when the original changes");
+    AssertEquals(string, StringWithoutNull("read on write"), "String replace-at*count*with* changes the original of a copy");
+}
+
 static void TestString() {
     TestStringEquals();
+    TestStringCompare();
+    TestStringReplaceAtCountWith();
+    TestStringRope();
+    TestStringAtCount();
+    TestStringAtCountLarge();
+    TestStringHashLarge();
+    TestStringInternConcurrently();
+    TestStringConstant();
+    TestStringCopy();
     // TODO: add more tests.
 }
 
+// ------------------------------------------------- String Builder Tests ------
+
+static void TestStringBuilderAppend() {
+    MLVariable builder = MLSend(MLStringBuilder, "create");
+    MLSend(builder, "append*", StringWithoutNull("count: "));
+    MLSend(builder, "append*", MLNumber(42));
+    MLSend(builder, "append*", DataWithoutNull(", ratio: "));
+    MLSend(builder, "append*", MLNumber(1.5));
+    MLSend(builder, "append*", StringWithoutNull(", done"));
+    AssertEquals(MLSend(builder, "length"), MLNumber(27), "StringBuilder append* appends strings, numbers and data");
+    AssertEquals(MLSend(builder, "as-string"), StringWithoutNull("count: 42, ratio: 1.5, done"), "StringBuilder as-string returns the appended characters");
+}
+
+static void TestStringBuilderFreeze() {
+    MLVariable builder = MLSend(MLStringBuilder, "create");
+    MLSend(builder, "append*", StringWithoutNull("get"));
+    MLSend(builder, "append*", StringWithoutNull("*"));
+    MLVariable string = MLSend(builder, "freeze");
+    AssertIdentical(string, StringWithoutNull("get*"), "StringBuilder freeze interns short strings");
+    AssertEquals(MLSend(builder, "length"), MLNumber(0), "StringBuilder freeze leaves the builder empty");
+    AssertNo(MLSend(string, "is-mutable"), "StringBuilder freeze returns an immutable string");
+
+    char characters[10000];
+    for (int i = 0; i < 10000; i += 1) characters[i] = 'a' + (i % 26);
+    for (int i = 0; i < 10000; i += 100) MLSend(builder, "append*", MLCollectBlockAdd(MLStringMake(100, characters + i)));
+    MLVariable large = MLSend(builder, "freeze");
+    AssertEquals(large, MLCollectBlockAdd(MLStringMake(10000, characters)), "StringBuilder freeze returns long strings with all appended characters");
+
+    MLSend(builder, "append*", StringWithoutNull("again"));
+    AssertEquals(MLSend(builder, "freeze"), StringWithoutNull("again"), "StringBuilder can be reused after freeze");
+}
+
+static void TestStringBuilder() {
+    TestStringBuilderAppend();
+    TestStringBuilderFreeze();
+}
+
 // ----------------------------------------------------- Dictionary Tests ------
 
 static void TestDictionaryEquals() {
@@ -412,15 +1212,276 @@ static void TestDictionaryRemove() {
     // TODO: check that non-mutable dictionaries raise an exception when trying to mutate.
 }
 
+static void TestDictionaryMany() {
+    MLVariable dictionary = MLDictionary(MLMore);
+    for (int i = 0; i < 2000; i += 1) MLSend(dictionary, "set*to*", MLNumber(i), MLNumber(i * 2));
+    for (int i = 0; i < 2000; i += 2) MLSend(dictionary, "remove*", MLNumber(i));
+
+    bool found = true;
+    for (int i = 1; i < 2000; i += 2) found = found && MLSend(MLSend(dictionary, "get*", MLNumber(i)), "equals*", MLNumber(i * 2)) == MLYes;
+    AssertYes(MLBoolean(found), "Dictionary get* finds all values while a large dictionary grows and shrinks");
+    AssertEquals(MLSend(dictionary, "count"), MLNumber(1000), "Dictionary remove* decrements the count of a large dictionary");
+    AssertNull(MLSend(dictionary, "get*", MLNumber(0)), "Dictionary remove* removes the entry from a large dictionary (here: key = 0)");
+
+    for (int i = 1; i < 2000; i += 2) MLSend(dictionary, "remove*", MLNumber(i));
+    AssertEquals(MLSend(dictionary, "count"), MLNumber(0), "Dictionary remove* removes all entries from a large dictionary");
+    AssertNull(MLSend(dictionary, "get*", MLNumber(1999)), "Dictionary get* returns MLNull after a large dictionary shrank (here: key = 1999)");
+}
+
+static void TestDictionaryEnumerate() {
+    MLVariable dictionary = MLDictionary(MLMore);
+    MLInteger sum = 0;
+    MLInteger count = 0;
+
+    for (int i = 0; i < 1000; i += 1) MLSend(dictionary, "set*to*", MLNumber(i), MLNumber(i));
+
+    MLForEach(key, dictionary) {
+        sum += MLIntegerFrom(key);
+        count += 1;
+    }
+
+    AssertEquals(MLNumber(count), MLNumber(1000), "Dictionary enumerate* enumerates all keys, also while the entries are being migrated");
+    AssertEquals(MLNumber(sum), MLNumber(999 * 1000 / 2), "Dictionary enumerate* enumerates every key once");
+
+    AssertRaises("Dictionary enumerate* raises an exception when the dictionary is mutated while being enumerated") {
+        MLForEach(key, dictionary) MLSend(dictionary, "remove*", key);
+    }
+}
+
+// Copying finishes migrating the entries, which moves those not enumerated
+// yet. Whenever it does, enumerating has to fail instead of skipping keys.
+static void TestDictionaryCopyWhileEnumerating() {
+    MLVariable dictionary = MLDictionary(MLMore);
+    long raisedCount = 0;
+    bool isComplete = true;
+
+    for (int i = 0; i < 600; i += 1) {
+        MLSend(dictionary, "set*to*", MLNumber(i), MLNumber(i));
+        long volatile count = 0;
+
+        MLPerform {
+            MLForEach(key, dictionary) {
+                if (count == 0) MLSend(MLSend(dictionary, "copy"), "collect");
+                count += 1;
+            }
+            isComplete = isComplete && count == i + 1;
+        }
+        MLHandle {
+            raisedCount += 1;
+        }
+    }
+
+    AssertYes(MLBoolean(isComplete), "Dictionary enumerate* enumerates every key when a copy doesn't move any entries");
+    AssertYes(MLBoolean(raisedCount > 0), "Dictionary enumerate* raises an exception when a copy moves the entries being enumerated");
+}
+
+static void TestDictionaryCopy() {
+    MLVariable dictionary = MLDictionary(MLMore);
+    for (int i = 0; i < 100; i += 1) MLSend(dictionary, "set*to*", MLNumber(i), MLNumber(i));
+
+    MLVariable copy = MLSend(MLSend(dictionary, "copy"), "collect");
+    MLVariable mutableCopy = MLSend(MLSend(dictionary, "copy", MLString("mutable"), MLYes), "collect");
+    AssertNo(MLSend(copy, "is-mutable"), "Dictionary copy of a mutable dictionary returns an immutable dictionary");
+    AssertEquals(copy, dictionary, "Dictionary copy has the same entries");
+
+    MLSend(dictionary, "remove*", MLNumber(0));
+    MLSend(mutableCopy, "set*to*", MLNumber(1), MLString("one"));
+    AssertEquals(MLSend(copy, "get*", MLNumber(0)), MLNumber(0), "Dictionary copy keeps its entries when the original changes");
+    AssertEquals(MLSend(copy, "get*", MLNumber(1)), MLNumber(1), "Dictionary copy keeps its entries when another copy changes");
+    AssertEquals(MLSend(mutableCopy, "get*", MLNumber(1)), MLString("one"), "Dictionary copy changes on its own when mutable");
+    AssertNull(MLSend(dictionary, "get*", MLNumber(0)), "Dictionary remove* changes the original of a copy");
+    AssertEquals(MLSend(dictionary, "count"), MLNumber(99), "Dictionary copy doesn't change the count of the original");
+}
+
+static void TestDictionaryHash() {
+    MLVariable dictionary1 = MLDictionary(MLNumber(1), StringWithoutNull("one"), MLNumber(2), StringWithoutNull("two"), MLMore);
+    MLVariable dictionary2 = MLDictionary(MLNumber(2), StringWithoutNull("two"), MLNumber(1), StringWithoutNull("one"), MLMore);
+    AssertEquals(MLSend(dictionary1, "hash"), MLSend(dictionary2, "hash"), "Dictionary hash doesn't depend on the order of the entries");
+    AssertEquals(dictionary1, dictionary2, "Dictionary equals* returns MLYes for the same entries in another order");
+
+    MLSend(dictionary2, "set*to*", MLNumber(2), StringWithoutNull("deux"));
+    AssertNotEqual(MLSend(dictionary1, "hash"), MLSend(dictionary2, "hash"), "Dictionary set*to* clears the cached hash");
+    AssertNotEqual(dictionary1, dictionary2, "Dictionary equals* returns MLNo for different values");
+
+    MLVariable keys = MLDictionary(dictionary1, MLYes, MLMore);
+    MLSend(dictionary2, "set*to*", MLNumber(2), StringWithoutNull("two"));
+    AssertEquals(MLSend(keys, "get*", dictionary2), MLYes, "Dictionary hash lets dictionaries be used as dictionary keys");
+    MLSend(dictionary2, "remove*", MLNumber(2));
+    AssertNull(MLSend(keys, "get*", dictionary2), "Dictionary remove* clears the cached hash");
+}
+
 static void TestDictionary() {
     TestDictionaryEquals();
     TestDictionaryCount();
     TestDictionaryGet();
     TestDictionarySetTo();
     TestDictionaryRemove();
+    TestDictionaryMany();
+    TestDictionaryEnumerate();
+    TestDictionaryCopy();
+    TestDictionaryCopyWhileEnumerating();
+    TestDictionaryHash();
     // TODO: add more tests.
 }
 
+// ------------------------------------------ Persistent Dictionary Tests ------
+
+static void TestPersistentDictionaryEquals() {
+    MLVariable dictionary1 = MLPersistentDictionary(MLString("one"), MLNumber(1), MLString("two"), MLNumber(2));
+    MLVariable dictionary2 = MLPersistentDictionary(MLString("two"), MLNumber(2), MLString("one"), MLNumber(1));
+    MLVariable dictionary3 = MLPersistentDictionary(MLString("one"), MLNumber(1), MLString("three"), MLNumber(3));
+    AssertYes(MLSend(dictionary1, "equals*", dictionary1), "PersistentDictionary equals* returns MLYes when comparing identical dictionaries");
+    AssertYes(MLSend(dictionary1, "equals*", dictionary2), "PersistentDictionary equals* returns MLYes when comparing dictionaries with the same key/value pairs");
+    AssertNo(MLSend(dictionary1, "equals*", dictionary3), "PersistentDictionary equals* returns MLNo when comparing dictionaries with different key/value pairs");
+    AssertNo(MLSend(dictionary1, "equals*", MLNumber(9)), "PersistentDictionary equals* returns MLNo when comparing a dictionary to a number (here: 9)");
+}
+
+static void TestPersistentDictionaryAsString() {
+    MLVariable dictionary = MLPersistentDictionary(StringWithoutNull("one"), MLNumber(1));
+    AssertEquals(MLSend(MLPersistentDictionary, "as-string"), MLString("PersistentDictionary"), "PersistentDictionary as-string returns 'PersistentDictionary' for PersistentDictionary");
+    AssertEquals(MLSend(MLPersistentDictionary(), "as-string"), StringWithoutNull("{}"), "PersistentDictionary as-string returns '{}' for an empty dictionary");
+    AssertEquals(MLSend(dictionary, "as-string"), StringWithoutNull("{one: 1}"), "PersistentDictionary as-string lists the keys and values");
+
+    MLVariable string = MLSend(MLSend(dictionary, "set*to*", StringWithoutNull("two"), MLNumber(2.5)), "as-string");
+    bool const isListed = MLSend(string, "equals*", StringWithoutNull("{one: 1, two: 2.5}")) == MLYes || MLSend(string, "equals*", StringWithoutNull("{two: 2.5, one: 1}")) == MLYes;
+    AssertYes(MLBoolean(isListed), "PersistentDictionary as-string separates the entries with commas");
+}
+
+static void TestPersistentDictionaryHash() {
+    MLVariable dictionary1 = MLPersistentDictionary(MLString("one"), MLNumber(1), MLString("two"), MLNumber(2));
+    MLVariable dictionary2 = MLPersistentDictionary(MLString("two"), MLNumber(2), MLString("one"), MLNumber(1));
+    MLVariable dictionary3 = MLPersistentDictionary(MLString("one"), MLNumber(1), MLString("two"), MLNumber(3));
+    AssertEquals(MLSend(dictionary1, "hash"), MLSend(dictionary2, "hash"), "PersistentDictionary hash is the same for equal dictionaries, regardless of the order of the entries");
+    AssertNotEqual(MLSend(dictionary1, "hash"), MLSend(dictionary3, "hash"), "PersistentDictionary hash differs for dictionaries with different values");
+
+    MLVariable array1 = MLArray(dictionary1);
+    MLVariable array2 = MLArray(dictionary2);
+    AssertYes(MLSend(array1, "equals*", array2), "Array equals* returns MLYes for arrays of equal persistent dictionaries");
+    AssertEquals(MLSend(array1, "hash"), MLSend(array2, "hash"), "Array hash is the same for arrays of equal persistent dictionaries");
+    AssertYes(MLSend(array1, "equals*", array2), "Array equals* returns MLYes for arrays of equal persistent dictionaries once their hashes are cached");
+}
+
+static void TestPersistentDictionaryCount() {
+    MLVariable dictionary1 = MLPersistentDictionary();
+    MLVariable dictionary2 = MLPersistentDictionary(MLString("one"), MLNumber(1));
+    MLVariable dictionary3 = MLPersistentDictionary(MLString("one"), MLNumber(1), MLString("two"), MLNumber(2), MLString("three"), MLNumber(3));
+    AssertEquals(MLSend(dictionary1, "count"), MLNumber(0), "PersistentDictionary count returns X for a dictionary with X key/value pairs (here: X = 0)");
+    AssertEquals(MLSend(dictionary2, "count"), MLNumber(1), "PersistentDictionary count returns X for a dictionary with X key/value pairs (here: X = 1)");
+    AssertEquals(MLSend(dictionary3, "count"), MLNumber(3), "PersistentDictionary count returns X for a dictionary with X key/value pairs (here: X = 3)");
+}
+
+static void TestPersistentDictionaryGet() {
+    MLVariable dictionary = MLPersistentDictionary(MLString("one"), MLNumber(1), MLString("two"), MLNumber(2));
+    MLVariable collisions = MLPersistentDictionary(MLNumber(1), MLString("one"), MLNumber(1.5), MLString("one and a half"));
+    AssertEquals(MLSend(dictionary, "get*", MLString("one")), MLNumber(1), "PersistentDictionary get* returns the value for the given key (here: key = 'one', value = 1)");
+    AssertEquals(MLSend(dictionary, "get*", MLString("two")), MLNumber(2), "PersistentDictionary get* returns the value for the given key (here: key = 'two', value = 2)");
+    AssertNull(MLSend(dictionary, "get*", MLString("three")), "PersistentDictionary get* returns MLNull if the given key is not in the dictionary (here: key = 'three')");
+    AssertEquals(MLSend(collisions, "get*", MLNumber(1.5)), MLString("one and a half"), "PersistentDictionary get* distinguishes keys with colliding hashes (here: 1 and 1.5)");
+}
+
+static void TestPersistentDictionaryGetCollisionsTransient() {
+    MLVariable transient = MLPersistentDictionary(MLMore);
+    MLSend(transient, "set*to*", MLNumber(1), MLString("one"));
+    MLSend(transient, "set*to*", MLNumber(1.5), MLString("one and a half"));
+    MLSend(transient, "set*to*", MLNumber(1.25), MLString("one and a quarter"));
+    AssertEquals(MLSend(transient, "get*", MLNumber(1)), MLString("one"), "PersistentDictionary get* on a transient returns the first of three keys with colliding hashes");
+    AssertEquals(MLSend(transient, "get*", MLNumber(1.5)), MLString("one and a half"), "PersistentDictionary get* on a transient returns the second of three keys with colliding hashes");
+    AssertEquals(MLSend(transient, "get*", MLNumber(1.25)), MLString("one and a quarter"), "PersistentDictionary get* on a transient returns the third of three keys with colliding hashes");
+    AssertEquals(MLSend(transient, "count"), MLNumber(3), "PersistentDictionary set*to* on a transient counts keys with colliding hashes");
+}
+
+static void TestPersistentDictionarySetTo() {
+    MLVariable dictionary1 = MLPersistentDictionary(MLString("one"), MLNumber(1));
+    MLVariable dictionary2 = MLSend(dictionary1, "set*to*", MLString("two"), MLNumber(2));
+    MLVariable dictionary3 = MLSend(dictionary2, "set*to*", MLString("one"), MLNumber(3));
+    AssertEquals(MLSend(dictionary2, "get*", MLString("two")), MLNumber(2), "PersistentDictionary set*to* returns a new version containing the entry for `key`");
+    AssertNull(MLSend(dictionary1, "get*", MLString("two")), "PersistentDictionary set*to* leaves the receiver unchanged");
+    AssertEquals(MLSend(dictionary3, "get*", MLString("one")), MLNumber(3), "PersistentDictionary set*to* replaces the value of an existing key in the new version");
+    AssertEquals(MLSend(dictionary2, "get*", MLString("one")), MLNumber(1), "PersistentDictionary set*to* doesn't replace the value of an existing key in the receiver");
+}
+
+static void TestPersistentDictionaryRemove() {
+    MLVariable dictionary1 = MLPersistentDictionary(MLString("one"), MLNumber(1), MLString("two"), MLNumber(2));
+    MLVariable dictionary2 = MLSend(dictionary1, "remove*", MLString("one"));
+    AssertNull(MLSend(dictionary2, "get*", MLString("one")), "PersistentDictionary remove* returns a new version without the entry for `key`");
+    AssertEquals(MLSend(dictionary2, "count"), MLNumber(1), "PersistentDictionary remove* decrements the count of the new version");
+    AssertEquals(MLSend(dictionary1, "get*", MLString("one")), MLNumber(1), "PersistentDictionary remove* leaves the receiver unchanged");
+    AssertIdentical(MLSend(dictionary1, "remove*", MLString("three")), dictionary1, "PersistentDictionary remove* returns the receiver if `key` is not in the dictionary");
+}
+
+static void TestPersistentDictionaryCopy() {
+    MLVariable transient = MLPersistentDictionary(MLString("one"), MLNumber(1), MLMore);
+    MLVariable snapshot = MLSend(MLSend(transient, "copy"), "collect");
+    MLSend(transient, "set*to*", MLString("two"), MLNumber(2));
+    MLSend(transient, "remove*", MLString("one"));
+    AssertYes(MLSend(transient, "is-mutable"), "PersistentDictionary with MLMore is a mutable transient");
+    AssertNo(MLSend(snapshot, "is-mutable"), "PersistentDictionary copy of a transient returns an immutable snapshot");
+    AssertEquals(MLSend(snapshot, "get*", MLString("one")), MLNumber(1), "PersistentDictionary copy isn't affected by later edits of the transient");
+    AssertNull(MLSend(snapshot, "get*", MLString("two")), "PersistentDictionary copy doesn't see entries added to the transient later on");
+    AssertEquals(MLSend(transient, "get*", MLString("two")), MLNumber(2), "PersistentDictionary set*to* on a transient changes it in place");
+}
+
+static void TestPersistentDictionaryMany() {
+    MLVariable transient = MLPersistentDictionary(MLMore);
+    for (int i = 0; i < 2000; i += 1) MLSend(transient, "set*to*", MLNumber(i * 7919), MLNumber(i));
+    MLVariable snapshot = MLSend(MLSend(transient, "copy"), "collect");
+    for (int i = 0; i < 2000; i += 2) MLSend(transient, "remove*", MLNumber(i * 7919));
+
+    bool found = true;
+    for (int i = 0; i < 2000; i += 1) found = found && MLSend(MLSend(snapshot, "get*", MLNumber(i * 7919)), "equals*", MLNumber(i)) == MLYes;
+    AssertYes(MLBoolean(found), "PersistentDictionary get* finds all values in a large snapshot");
+    AssertEquals(MLSend(transient, "count"), MLNumber(1000), "PersistentDictionary remove* removes entries from a large transient");
+    AssertNull(MLSend(transient, "get*", MLNumber(0)), "PersistentDictionary remove* removes the entry from a large transient");
+    AssertEquals(MLSend(transient, "get*", MLNumber(7919)), MLNumber(1), "PersistentDictionary remove* keeps other entries of a large transient");
+}
+
+static void* TestPersistentDictionaryDeriveThread(void* snapshot) {
+    bool* const derived = calloc(1, sizeof(bool));
+    *derived = true;
+
+    for (int i = 0; i < 2000; i += 1) MLCollect {
+        MLVariable version = MLSend(snapshot, "set*to*", MLNumber(i % 64), MLNumber(-i));
+        *derived = *derived && MLSend(MLSend(version, "get*", MLNumber(i % 64)), "equals*", MLNumber(-i)) == MLYes;
+        *derived = *derived && MLSend(MLSend(version, "get*", MLNumber((i + 1) % 64)), "equals*", MLNumber((i + 1) % 64)) == MLYes;
+    }
+
+    return derived;
+}
+
+static void TestPersistentDictionaryDeriveConcurrently() {
+    MLVariable transient = MLPersistentDictionary(MLMore);
+    for (int i = 0; i < 64; i += 1) MLSend(transient, "set*to*", MLNumber(i), MLNumber(i));
+    MLVariable snapshot = MLSend(MLSend(transient, "copy"), "collect");
+    pthread_t threads[4];
+    bool derived = true;
+
+    for (int i = 0; i < 4; i += 1) pthread_create(&threads[i], NULL, TestPersistentDictionaryDeriveThread, snapshot);
+    for (int i = 0; i < 4; i += 1) {
+        bool* result = MLZero;
+        pthread_join(threads[i], (void**)&result);
+        derived = derived && *result;
+        free(result);
+    }
+
+    AssertYes(MLBoolean(derived), "PersistentDictionary set*to* derives versions of a snapshot shared by several threads");
+    AssertEquals(MLSend(snapshot, "get*", MLNumber(5)), MLNumber(5), "PersistentDictionary set*to* from several threads leaves the shared snapshot unchanged");
+    AssertEquals(MLSend(snapshot, "count"), MLNumber(64), "PersistentDictionary set*to* from several threads keeps the count of the shared snapshot");
+}
+
+static void TestPersistentDictionary() {
+    TestPersistentDictionaryAsString();
+    TestPersistentDictionaryEquals();
+    TestPersistentDictionaryHash();
+    TestPersistentDictionaryCount();
+    TestPersistentDictionaryGet();
+    TestPersistentDictionaryGetCollisionsTransient();
+    TestPersistentDictionarySetTo();
+    TestPersistentDictionaryRemove();
+    TestPersistentDictionaryCopy();
+    TestPersistentDictionaryMany();
+    TestPersistentDictionaryDeriveConcurrently();
+}
+
 // ----------------------------------------------------------- Null Tests ------
 
 static void TestNullEquals() {
@@ -446,8 +1507,11 @@ int main(int argumentsCount, char const* arguments[]) {
         TestBlock();
         TestData();
         TestArray();
+        TestNumberArray();
         TestString();
+        TestStringBuilder();
         TestDictionary();
+        TestPersistentDictionary();
         TestNull();
         TestEnd();
     }